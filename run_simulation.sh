@@ -2,7 +2,8 @@
 
 # check all input flags
 # flag t and m requires parameter (indicated with : at the end)
-while getopts "hm:t:" FLAG; do
+options=""
+while getopts "hm:t:wavAcgsVnif:l:p:M:N:K:" FLAG; do
     case $FLAG in
         m) 
             mode=${OPTARG}
@@ -10,19 +11,83 @@ while getopts "hm:t:" FLAG; do
         t) 
             topology=${OPTARG}
             ;;
+        w)
+            options="$options --warmup"
+            ;;
+        a)
+            options="$options --adaptive-batch"
+            ;;
+        v)
+            options="$options --variance"
+            ;;
+        A)
+            options="$options --antithetic"
+            ;;
+        c)
+            options="$options --control-variates"
+            ;;
+        g)
+            options="$options --gradient"
+            ;;
+        s)
+            options="$options --select"
+            ;;
+        V)
+            options="$options --validate"
+            ;;
+        n)
+            options="$options --no-cache"
+            ;;
+        i)
+            options="$options --incremental"
+            ;;
+        f)
+            options="$options --model ${OPTARG}"
+            ;;
+        l)
+            options="$options --arrivals ${OPTARG}"
+            ;;
+        p)
+            options="$options --precision ${OPTARG}"
+            ;;
+        M)
+            options="$options --metrics ${OPTARG}"
+            ;;
+        N)
+            options="$options --nodes ${OPTARG}"
+            ;;
+        K)
+            options="$options --classes ${OPTARG}"
+            ;;
         h)
             echo "run_simulation - execute finite/infinite horizon simulation on a specific microservices app topology"
             echo " "
-            echo "syntax: $0 [ -h | -m mode | -t topology ]"
+            echo "syntax: $0 [ -h | -m mode | -t topology | -w | -a | -v | -A | -c | -g | -s | -V | -n | -i | -f model | -l log | -p precision | -M metrics | -N nodes | -K classes ]"
             echo " "
             echo "options:"
             echo "-h,              show brief help"
-            echo "-m mode,         specify mode to use [ FINITE | INFINITE ]"
-            echo "-t topology,     specify topology to use [ BASE | RESIZED | IMPROVED ]"
+            echo "-m mode,         specify mode to use [ FINITE | INFINITE | REGENERATIVE | RARE | ANALYTIC | BENCHMARK ]"
+            echo "-t topology,     specify topology to use [ BASE | RESIZED | IMPROVED | COMPARE | OPTIMIZE | MESH ]"
+            echo "-w,              discard the initial transient detected with MSER-5 (INFINITE mode only)"
+            echo "-a,              select the batch size with the lag-1 autocorrelation test (INFINITE mode only)"
+            echo "-v,              compare batch means, overlapping batch means and spectral CIs (INFINITE mode only)"
+            echo "-A,              run the replicas in antithetic pairs (FINITE mode only)"
+            echo "-c,              report control-variate adjusted estimators next to the raw ones"
+            echo "-g,              estimate the IPA derivatives of the waits and of the response time w.r.t. every mu and lambda"
+            echo "-s,              rank the close contenders of the optimizer with the KN procedure (OPTIMIZE only)"
+            echo "-V,              compare the estimates with the analytic solution (INFINITE and REGENERATIVE modes only)"
+            echo "-n,              simulate every replica/batch again instead of reusing the result cache"
+            echo "-i,              replay the recorded arrivals at payment_control when only payment_control changes (COMPARE and OPTIMIZE only)"
+            echo "-f model,        read servers, rates, queues and routing of the topology from a model file (e.g. source/models/base.ini)"
+            echo "-l log,          replay the requests of an arrival log (time;entry node[;service at every node]) instead of Poisson arrivals, a CSV log is converted to a mapped .bin"
+            echo "-p precision,    add replicas/batches until the relative CI half-width is below precision (e.g. 0.01)"
+            echo "-M metrics,      metrics checked by -p, comma separated [ response,ploss,wait ] (default response,ploss)"
+            echo "-N nodes,        simulate only a mesh of this size instead of 10 to 10000 nodes (MESH only)"
+            echo "-K classes,      number of priority classes of the mesh (MESH only, default 4)"
             exit 0
             ;;
         ?) 
-            echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED> ] [ -m <FINITE|INFINITE> ]" >&2
+            echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED|COMPARE|OPTIMIZE|MESH> ] [ -m <FINITE|INFINITE|REGENERATIVE|RARE|ANALYTIC|BENCHMARK> ]" >&2
             exit 1
             ;;
     esac
@@ -32,19 +97,19 @@ shift "$(( OPTIND - 1 ))"
 
 # check presence of mode and topology flags
 if [ -z "$mode" ] || [ -z "$topology" ] ; then
-        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED> ] [ -m <FINITE|INFINITE> ]" >&2
+        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED|COMPARE|OPTIMIZE|MESH> ] [ -m <FINITE|INFINITE|REGENERATIVE|RARE|ANALYTIC|BENCHMARK> ]" >&2
         exit 1
 fi
 
 # check mode flag
-if [ $mode != "FINITE" ] && [ $mode != "INFINITE" ]; then
-        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED> ] [ -m <FINITE|INFINITE> ]" >&2
+if [ $mode != "FINITE" ] && [ $mode != "INFINITE" ] && [ $mode != "REGENERATIVE" ] && [ $mode != "RARE" ] && [ $mode != "ANALYTIC" ] && [ $mode != "BENCHMARK" ]; then
+        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED|COMPARE|OPTIMIZE|MESH> ] [ -m <FINITE|INFINITE|REGENERATIVE|RARE|ANALYTIC|BENCHMARK> ]" >&2
         exit 1
 fi
 
 # check topology flag
-if [ $topology != "BASE" ] && [ $topology != "RESIZED" ] && [ $topology != "IMPROVED" ]; then
-        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED> ] [ -m <FINITE|INFINITE> ]" >&2
+if [ $topology != "BASE" ] && [ $topology != "RESIZED" ] && [ $topology != "IMPROVED" ] && [ $topology != "COMPARE" ] && [ $topology != "OPTIMIZE" ] && [ $topology != "MESH" ]; then
+        echo "script usage: $0 [ -t <BASE|RESIZED|IMPROVED|COMPARE|OPTIMIZE|MESH> ] [ -m <FINITE|INFINITE|REGENERATIVE|RARE|ANALYTIC|BENCHMARK> ]" >&2
         exit 1
 fi
 
@@ -55,4 +120,4 @@ make
 # start the correct simulation using lowercase flag
 cd ..
 clear
-./bin/simulation $topology $mode 
\ No newline at end of file
+./bin/simulation $topology $mode $options 
\ No newline at end of file
@@ -2,6 +2,13 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include "lib/rngs.h"
 #include "lib/rvgs.h"
 #include "lib/rvms.h"
@@ -15,13 +22,116 @@
 #define START                           0.0         // initial (open the door) time
 #define FINITE_HORIZON_STOP             86400.0     // terminal (close the door) time (1 day for transient analysis)
 #define INFINITE_HORIZON_STOP           864000.0    // terminal (close the door) time (1 day for steady state analysis)
+#define REGENERATIVE_MIN_CYCLES         30          // min number of regeneration cycles for the ratio estimators
+#define REGENERATIVE_PILOT_JOBS         100000      // external arrivals observed to select the regeneration state
+#define REGENERATIVE_MAX_STATE          256         // max population per node tracked by the pilot histogram
 
-#define NODES                           4           // number of nodes in the system
-#define PRIORITY_CLASSES                2           // number of priority queues of the last node in the improved scenario
+#define NODES                           8           // max nodes of the analysed networks, a model file can add nodes up to here (a benchmark mesh sizes the engine at runtime)
+#define COMPILED_NODES                  4           // nodes of the compiled topologies: flight, hotel, taxi, payment_control
+#define PRIORITY_CLASSES                2           // number of priority queues of the last node in the improved scenario (a benchmark mesh sets classes_num at runtime)
 #define INFINITE_CAPACITY               1 << 27     // large number to simulate infinite queue
 #define INFINITE_PROCESSABLE_JOBS       1 << 27     // large number to simulate infinite
 #define LOC                             0.95        // level of confidence, use 0.99 for 99% confidence
 
+// WARM-UP DETECTION VALUES (infinite horizon)
+#define WARMUP_OBS_SIZE                 100         // number of jobs in a single warm-up observation
+#define WARMUP_MSER_BATCH               5           // observations grouped in a single MSER point (MSER-5)
+#define WARMUP_MIN_GROUPS               20          // MSER points observed before accepting the truncation point (only the jobs before it are discarded)
+#define WARMUP_MAX_OBS                  2000        // max number of observations used to detect the warm-up
+
+// ADAPTIVE BATCH SIZE VALUES (infinite horizon)
+#define ADAPTIVE_MIN_BATCH_SIZE         500         // initial number of jobs in a single batch
+#define ADAPTIVE_MAX_BATCH_SIZE         256000      // max number of jobs in a single batch
+#define ADAPTIVE_ALPHA                  0.05        // significance level of the lag-1 autocorrelation test
+
+// ALTERNATIVE VARIANCE ESTIMATORS VALUES (infinite horizon)
+#define VARIANCE_INTERVAL_SIZE          1000        // number of jobs in a single interval of the stream (must divide BATCH_SIZE)
+#define SPECTRAL_LAGS                   36          // truncation lag of the spectral windows (in intervals)
+#define VARIANCE_ESTIMATORS             4           // number of variance estimators compared
+
+// COMMON RANDOM NUMBERS VALUES (topologies comparison)
+#define PROFILE_STREAM                  160         // first stream of the job profiles, one stream every 20 for each entry node
+#define COMPARED_TOPOLOGIES             3           // number of topologies compared with common random numbers
+#define LOCKSTEP_MAX_INSTANCES          16          // max configurations fed by the same input stream in a single pass
+
+// ANTITHETIC VARIATES VALUES (finite horizon)
+#define RNG_STREAMS                     256         // number of streams of the rngs library, all restored by the antithetic replica
+
+// CONTROL VARIATES VALUES
+#define NODE_CONTROLS                   2           // controls of a node: observed - expected service and offered interarrival
+
+// GRADIENT ESTIMATION VALUES
+#define IPA_PARAMETERS                  (2 * NODES) // parameters of the IPA derivatives: mu of every node, then lambda of every node
+#define GRADIENT_STEP                   1e-4        // relative step of the central differences on the analytic solution
+
+// RARE EVENT VALUES (importance sampling of the payment_control ploss)
+#define RARE_EVENT_MIN_CYCLES           30          // min number of plain cycles and tilted excursions for the estimators
+#define RARE_EVENT_SOURCE               -1          // server of the extra arrivals that raise the payment_control arrival rate in the tilted cycles
+#define RARE_EVENT_STREAM               250         // stream of the extra arrivals of the tilted cycles
+
+// SERVER OPTIMIZER VALUES
+#define QOS_MAX_PLOSS                   0.05        // max ploss on payment_control node
+#define QOS_MAX_RESPONSE                12.0        // max average response time of complete reservations (s)
+#define OPTIMIZER_MAX_SERVERS           16          // max number of servers of a single node
+#define OPTIMIZER_MAX_CANDIDATES        1024        // max number of configurations evaluated
+#define OPTIMIZER_WORKERS               4           // candidates simulated in parallel, one process each
+#define OPTIMIZER_SCREEN_MARGIN         0.1         // local search candidates with a larger analytic QoS violation are not simulated
+
+// RANKING AND SELECTION VALUES (KN procedure on the optimizer shortlist)
+#define SELECTION_INITIAL_OBS           10          // first-stage replicas/batches of every contending configuration
+#define SELECTION_MAX_OBS               512         // max replicas/batches of a single configuration
+#define SELECTION_MAX_SYSTEMS           16          // max configurations in the shortlist
+#define SELECTION_PCS                   0.95        // probability of correct selection
+#define SELECTION_INDIFFERENCE          0.1         // indifference zone of the response time (s)
+#define SELECTION_RESPONSE_MARGIN       0.05        // relative excess of the response time QoS still accepted in the shortlist
+
+// PRIORITY CTMC VALUES (payment_control of the improved topology)
+#define CTMC_MAX_QUEUE                  100         // truncation of an infinite payment_control queue
+#define CTMC_MAX_SWEEPS                 100000      // max number of Gauss-Seidel sweeps
+#define CTMC_TOLERANCE                  1e-11       // max change of a state probability in the last sweep
+
+// MODEL FILE
+#define MODEL_MAX_LINE                  512         // max length of a line of the model file
+#define MODEL_TOLERANCE                 1e-9        // tolerance on the sum of the routing probabilities of a node
+#define MODEL_MAX_NAME                  32          // max length of a node name of the model file
+#define ALIAS_MIN_OUTCOMES              8           // outcomes from which an alias table beats the scan of the cumulative thresholds
+#define ROUTE_MAX_OUTCOMES              17          // max outcomes of the routing table of a node, outside included
+
+// ARRIVAL LOG VALUES (trace-driven external arrivals)
+#define ARRIVAL_LOG_MAGIC               0x474C5241  // "ARLG", first bytes of a binary arrival log
+#define ARRIVAL_LOG_MIN_REQUESTS        2           // requests needed to know the span of the log
+
+// TIME-VARYING ARRIVAL VALUES (finite horizon)
+#define RATE_MAX_POINTS                 48          // max breakpoints of the daily rate profile of a node
+#define RATE_PERIOD                     FINITE_HORIZON_STOP // the rate profiles repeat every day
+#define RATE_HOUR                       3600.0      // breakpoints are given in hours of the day
+#define RATE_PIECE                      900.0       // pieces of a linear segment with their own thinning bound (s)
+#define RATE_BUCKETS                    24          // buckets of the day of the time-bucketed metrics (1 hour each)
+#define BUCKET_METRICS                  4           // metrics of a bucket: arrival rate, population, response time, payment_control ploss
+
+// MESH BENCHMARK VALUES (random networks simulated by the engine of the improved topology)
+#define MESH_MIN_NODES                  10          // smallest generated mesh, every next size is 10 times larger
+#define MESH_MAX_NODES                  10000       // largest generated mesh
+#define MESH_MAX_FANOUT                 16          // max destinations of a node (ROUTE_MAX_OUTCOMES - 1, the exit of the mesh is the last outcome)
+#define MESH_EXIT_PROB                  0.2         // probability that a job leaves the mesh after every node
+#define MESH_ENTRY_SHARE                0.1         // share of the nodes with external arrivals (the first ones)
+#define MESH_EXTERNAL_RATE              20.0        // total rate of the external arrivals (jobs/s), the same for every size
+#define MESH_UTILIZATION                0.7         // utilization used to size the servers of every node
+#define MESH_FINITE_SHARE               0.25        // share of the nodes with a finite queue
+#define MESH_QUEUE                      16          // places of a finite queue
+#define MESH_CLASSES                    4           // default number of priority classes
+#define MESH_BENCHMARK_JOBS             500000      // external arrivals simulated on every mesh
+#define MESH_STREAM                     224         // stream of the mesh generator
+
+// RESULT CACHE
+#define CACHE_VERSION                   6           // version of the simulation engine, change it when the same configuration gives different results or the stored state changes
+#define CACHE_HASH_BASIS                14695981039346656037ULL     // FNV-1a offset basis of the configuration hash
+#define CACHE_HASH_PRIME                1099511628211ULL            // FNV-1a prime of the configuration hash
+
+// SEQUENTIAL STOPPING VALUES
+#define SEQUENTIAL_MIN_ITER             10          // min number of replicas/batches before checking the precision
+#define SEQUENTIAL_MAX_ITER             1024        // max number of replicas/batches if the precision is never reached
+
 
 // DATA STRUCTURES
 typedef enum {
@@ -32,7 +142,11 @@ typedef enum {
 
 typedef enum {
   finite_horizon,
-  infinite_horizon
+  infinite_horizon,
+  regenerative,
+  rare_event,
+  analytic,
+  benchmark
 } simulation_mode;
 
 typedef enum {
@@ -43,11 +157,54 @@ typedef enum {
   outside = INFINITE_CAPACITY
 } node_id;
 
+typedef enum {
+  metric_response = 1,      // average response time of complete reservations
+  metric_ploss = 2,         // ploss of the payment_control node
+  metric_wait = 4           // average wait of every node
+} precision_metric;
+
 typedef enum {
   job_arrival,
   job_departure
 } event_type;
 
+typedef struct {            // routing of the jobs leaving a node, destinations in the order of the model
+  int fanout;                           // number of destinations (outside included)
+  node_id destination[ROUTE_MAX_OUTCOMES];
+  double prob[ROUTE_MAX_OUTCOMES];
+  double threshold[ROUTE_MAX_OUTCOMES]; // cumulative probability up to the destination
+  double cut[ROUTE_MAX_OUTCOMES];       // alias table: destination d is kept below cut[d], otherwise alias[d] is taken
+  int alias[ROUTE_MAX_OUTCOMES];
+} route_table;
+
+typedef struct {            // selection of the priority class at payment_control, built once from the class probabilities
+  int classes;
+  double *threshold;        // [class] cumulative probability up to the class
+  double *cut;              // [class] alias table, used with ALIAS_MIN_OUTCOMES classes or more
+  int *alias;               // [class]
+} priority_table;
+
+typedef struct {            // daily profile of the external arrival rate of a node, repeated every RATE_PERIOD
+  int points;               // breakpoints, 0 for the constant lambda of the node
+  int linear;               // 1 to interpolate between the breakpoints, 0 for a step profile
+  double time[RATE_MAX_POINTS + 1];     // start of every segment (s), time[points] = RATE_PERIOD
+  double rate[RATE_MAX_POINTS + 1];     // rate at the start of every segment, rate[points] = rate[0] of the next day
+  int segment;              // segment of the last generated arrival
+  double day;               // start time of the day of the last generated arrival
+  long candidates;          // candidate arrivals drawn from the bounds
+  long rejected;            // candidates discarded by the thinning
+} arrival_rates;
+
+typedef struct {            // parameters of a topology, the keys missing from the model file keep the compiled values
+  int nodes;                // nodes of the network, the sections with a new name are added after the compiled ones
+  double lambda[NODES];
+  double mu[NODES];
+  int servers[NODES];
+  unsigned long queue[NODES];
+  route_table routes[NODES];
+  arrival_rates rates[NODES];
+} topology_model;
+
 typedef struct event{
   event_type type;
   node_id node;
@@ -56,10 +213,18 @@ typedef struct event{
   struct event *next;
 } event;
 
+typedef struct {
+  double service[NODES];    // service demand of the job at every node
+  double route[NODES];      // uniform used to route the job when it leaves every node
+  int priority;             // priority class at payment_control
+} job_profile;
+
 typedef struct job{
   double arrival;
   double service;
   int priority;
+  job_profile *profile;     // random numbers drawn once per job (common random numbers only)
+  double *derivative;       // IPA derivatives of the arrival time at the current node, stored after the job only with --gradient
   struct job *next;
 } job;
 
@@ -68,14 +233,19 @@ typedef enum {
   busy
 } status;
 
-typedef struct {
+typedef struct {                   // state read on every arrival/departure
   int    status;                   // 0 = idle, 1 = busy
-  double service_time;             // total service time of the server
-  long   served_jobs;              // total jobs served by the server
+  int    next_idle;                // next server in the idle FIFO of the node, -1 if last
   double last_departure_time;      // required to select longest idle server
   job *serving_job;
 } server_stats;
 
+typedef struct {                   // statistics only updated at the departures and read by the analysis
+  double service_time;             // total service time of the server
+  long   served_jobs;              // total jobs served by the server
+  double *departure_derivative;    // IPA derivatives of the departure time of the serving job, NULL without --gradient
+} server_totals;
+
 typedef struct {
   long queue_jobs;        // jobs actually in the queue
   long service_jobs;      // jobs actually in the servers
@@ -85,7 +255,11 @@ typedef struct {
   double last_arrival;    // last arrival time of a job in the node
   job *queue;             // list of jobs in the queue of the node
   int total_servers;      // number of servers in the node
-  server_stats *servers;  // server status and stats
+  server_stats *servers;  // server status, the servers of all the nodes are contiguous
+  server_totals *totals;  // server stats, contiguous as well but apart from the status
+  int idle_head;          // longest idle server, -1 if all busy (idle servers in order of last departure)
+  int idle_tail;          // last server become idle
+  double *wait_derivative;  // [parameter] sum of the IPA derivatives of the waits of the processed jobs, NULL without --gradient
 } node_stats;
 
 typedef struct {
@@ -93,6 +267,27 @@ typedef struct {
   double queue_area;        // time integrated jobs in the queue
 } time_integrated;
 
+enum {
+  bucket_arrivals,          // external arrivals per second
+  bucket_population,        // time-averaged jobs in the system
+  bucket_response,          // response time of a complete reservation (sum of the node waits)
+  bucket_ploss              // ploss on payment_control
+};
+
+typedef struct {            // counters of the replica at the start of the current bucket
+  double node_area[NODES];
+  long processed[NODES];
+  long rejected[NODES];
+  long entered;             // external arrivals
+} bucket_mark;
+
+typedef struct {            // metrics of a bucket of the day over the replicas (Welford's one-pass method)
+  double expected;          // external arrival rate of the profiles over the bucket
+  long samples;
+  double mean[BUCKET_METRICS];
+  double sum[BUCKET_METRICS];           // sum of the squared deviations from the mean
+} time_bucket;
+
 enum {
   mean,
   interval
@@ -124,4 +319,247 @@ typedef struct {    // [0] = mean, [1] = confidence interval
   double ploss[NODES][2];
   double avg_max_wait[2];
   double priority_avg_max_wait[PRIORITY_CLASSES][2];    // used for priority queues
-} statistic_analysis;
\ No newline at end of file
+  long samples;                                         // number of replicas/batches used
+  long warmup;                                          // number of initial jobs discarded as warm-up, -1 without --warmup
+  long batch_size;                                      // batch size selected by the adaptive procedure (0 if fixed)
+  int antithetic;                                       // samples are averages of antithetic pairs of replicas
+} statistic_analysis;
+
+typedef enum {
+  batch_means,
+  overlapping_batch_means,
+  spectral_bartlett,
+  spectral_parzen
+} variance_estimator;
+
+typedef struct {
+  long intervals;                 // intervals recorded
+  long capacity;                  // allocated intervals
+  float *node_area;               // [interval*nodes_num + node] time integrated jobs in the node
+  float *queue_area;              // [interval*nodes_num + node] time integrated jobs in the queue
+  float *processed;               // [interval*nodes_num + node] jobs processed by the node
+  float *rejected;                // [interval*nodes_num + node] jobs rejected by the node
+  float *service;                 // [interval*nodes_num + node] service time of the jobs processed by the node
+  float *duration;                // [interval] length of the interval
+  double last_node_area[NODES];   // cumulative values at the end of the previous interval
+  double last_queue_area[NODES];
+  double last_service[NODES];
+  long last_processed[NODES];
+  long last_rejected[NODES];
+  double last_time;
+} interval_stream;
+
+typedef struct {    // [estimator][0] = mean, [estimator][1] = confidence interval
+  long intervals;
+  long batch_intervals;
+  double wait[NODES][VARIANCE_ESTIMATORS][2];
+  double Ns[NODES][VARIANCE_ESTIMATORS][2];
+  double ploss[NODES][VARIANCE_ESTIMATORS][2];
+  double avg_max_wait[VARIANCE_ESTIMATORS][2];
+} variance_analysis;
+
+typedef struct {    // control-variate adjusted estimates, [0] = mean, [1] = confidence interval
+  long samples;
+  double wait[NODES][2];
+  double delay[NODES][2];
+  double Ns[NODES][2];
+  double ploss[NODES][2];
+  double avg_max_wait[2];
+} control_variate_analysis;
+
+typedef struct {
+  long plain_cycles;        // payment_control cycles simulated with the original service rate
+  long tilted_cycles;       // payment_control cycles simulated with swapped arrival and service rates while all the servers are busy
+  long tilted_excursions;   // excursions of the tilted cycles with all the servers busy, tilted until their first rejection
+  double rate;              // arrival rate of payment_control
+  double mu;                // service rate of a single payment_control server
+  double tilted_rate;       // arrival rate of the tilted cycles, the service capacity c*mu
+  double tilted_mu;         // service rate of the tilted cycles, the arrival rate shared by the c servers
+  double analytic;          // ploss of the M/M/c/K payment_control node fed by Poisson arrivals
+  double arrivals[2];       // [0] = mean, [1] = sum of squared deviations of the arrivals per plain cycle
+  double rejections[2];     // same for the rejections per plain cycle
+  double comoment;          // sum of the products of the deviations of arrivals and rejections per plain cycle
+  double excursions[2];     // same for the excursions with all the servers busy per plain cycle
+  double excursion_comoment; // sum of the products of the deviations of arrivals and excursions per plain cycle
+  double weighted[2];       // same for the rejections per tilted excursion multiplied by the likelihood ratio
+  double plain_ploss[2];    // crude estimate, [0] = mean, [1] = confidence interval
+  double ploss[2];          // importance sampling estimate, [0] = mean, [1] = confidence interval
+} rare_event_analysis;
+
+typedef struct {            // IPA derivatives of the averages of a single replica/batch
+  double wait[NODES][IPA_PARAMETERS];
+} gradient_sample;
+
+typedef struct {    // [node][parameter][0] = mean, [node][parameter][1] = confidence interval
+  long samples;
+  double wait[NODES][IPA_PARAMETERS][2];
+  double avg_max_wait[IPA_PARAMETERS][2];
+  int biased[NODES];                        // finite queue or priority scheduling: the sample path has jumps missed by IPA
+  int lambda_omitted;                       // steady state: IPA has no derived estimator of the lambda derivatives, their rows are not shown
+  int exact;                                // the analytic derivatives are available (steady state only)
+  double exact_wait[NODES][IPA_PARAMETERS]; // central differences of the analytic solution
+  double exact_avg_max_wait[IPA_PARAMETERS];
+} gradient_analysis;
+
+typedef struct {
+  int servers[NODES];       // servers of every node
+  int cost;                 // total number of servers
+  int stable;               // every node with an infinite queue has load < 1
+  int evaluated;            // simulated (unstable candidates are pruned without simulation)
+  int screened;             // discarded by the analytic solution before simulation
+  double ploss[2];          // ploss on payment_control node, [0] = mean, [1] = confidence interval
+  double response[2];       // average response time of complete reservations
+  int pareto;               // not dominated in cost, ploss and response time
+} server_candidate;
+
+typedef struct {
+  server_candidate *candidate;          // configuration simulated by the system
+  long streams[RNG_STREAMS];            // streams at the end of the last observation
+  event *list;                          // event list of the single run (infinite horizon)
+  node_stats *nodes;
+  time_integrated *areas;
+  double current_time;
+  double first_batch_arrival[NODES];
+  unsigned long external_arrivals;
+  long observations;                    // replicas/batches simulated
+  double response;                      // average response time of the observations
+  long eliminated;                      // observations when eliminated (0 = still contending)
+} selection_system;
+
+typedef struct {
+  unsigned long long key;   // hash of model, seed, mode and engine version
+  long records;             // replicas/batches stored, each followed by its priority class records (improved topology)
+  long discarded;           // warm-up observations discarded before the first batch
+  int priority;             // records of the priority classes stored
+  int nodes;                // nodes, events and jobs stored with the state (infinite horizon), otherwise only streams and clock
+} cache_header;
+
+typedef struct {             // state needed to continue a run after the last cached replica/batch
+  event **list;
+  node_stats *nodes;                    // NULL between replicas (finite horizon)
+  time_integrated *areas;
+  node_stats *priority_nodes;
+  time_integrated *priority_areas;
+  double *current_time;
+  double *first_arrival;
+  unsigned long *external_arrivals;
+} cache_state;
+
+typedef struct {
+  cache_header header;
+  char filename[64];
+  int enabled;              // the run can be stored and continued (plain FINITE or INFINITE runs only)
+} result_cache;
+
+typedef struct {            // header of a binary arrival log, followed by the requests
+  unsigned int magic;
+  int services;             // every request is followed by its service demand at each node (< 0 to draw it from mu)
+  long requests;
+  long entries[COMPILED_NODES];   // requests entering every node
+  double span;              // time between the first and the last request, the first one is at 0
+} arrival_log_header;
+
+typedef struct {            // request of a binary arrival log
+  double time;              // arrival time from the first request
+  int entry;                // node reached by the request
+  int reserved;
+} log_request;
+
+typedef struct {
+  arrival_log_header header;
+  char *requests;           // mapped requests, stride bytes each
+  size_t stride;
+  void *map;
+  size_t map_size;
+  long cursor;              // next request to replay
+  double offset;            // time added to the requests: the log is replayed again after its end
+} arrival_log;
+
+typedef struct {            // arrival at payment_control recorded by a full simulation (priority < 0 marks the end of a replica/batch)
+  double time;
+  double service;           // service demand at payment_control
+  int priority;
+} trace_arrival;
+
+typedef struct {            // statistics of a node upstream of payment_control at the end of a replica/batch
+  long processed_jobs;
+  long rejected_jobs;
+  double last_arrival;
+  time_integrated area;
+  double service_time[OPTIMIZER_MAX_SERVERS];
+  long served_jobs[OPTIMIZER_MAX_SERVERS];
+} trace_node;
+
+typedef struct {
+  unsigned long long key;   // hash of the upstream nodes, the arrivals, the seed and the mode
+  long arrivals;            // recorded arrivals, markers included
+  long records;             // replicas/batches
+} trace_header;
+
+typedef struct {
+  trace_header header;
+  char filename[64];
+  char tmpname[80];
+  FILE *file;               // trace being recorded (NULL otherwise)
+  trace_node *upstream;     // [record * payment_control + node], in memory while recording, mapped while replaying
+  trace_arrival *arrivals;  // mapped arrivals while replaying
+  void *map;
+  size_t map_size;
+} incremental_trace;
+
+typedef struct {            // configuration simulated in lockstep with the others on the same input stream
+  project_topology topology;
+  int servers[NODES];
+  event *list;              // departures of the instance, the external arrivals come from the input stream
+  node_stats *nodes;
+  time_integrated *areas;
+  node_stats *priority_nodes;
+  time_integrated *priority_areas;
+  double current_time;
+  double first_batch_arrival[NODES];
+  analysis **result;
+} lockstep_instance;
+
+typedef struct {            // random feed-forward network sized at runtime, with the parameters in the layout of the engine
+  int nodes;
+  int classes;
+  int entries;              // nodes with external arrivals, the first ones with the same rate
+  long edges;               // outcomes of the routing tables, the exits of the mesh included
+  node_id busiest;          // node with the highest arrival rate, it orders its queue by priority class as payment_control
+  double *lambda;           // [node] rate of the external arrivals
+  double *mu;               // [node] service rate of a single server
+  int *servers;             // [node]
+  unsigned long *queue;     // [node] places in the queue
+  route_table *routes;      // [node]
+  double *class_prob;       // [class]
+} mesh_network;
+
+typedef struct {
+  int nodes;
+  long edges;
+  int classes;
+  long events;              // arrivals and departures processed
+  double seconds;           // CPU time of the simulation (generation excluded)
+  double state_bytes;       // memory per node of parameters, routing, node and server state
+  double peak_bytes;        // memory per node including the jobs and the events pending at the peak population
+  double population;        // time-averaged jobs in the mesh
+  double wait;              // average wait of a job at a node
+  double ploss;             // share of the arrivals rejected by a full queue
+} mesh_benchmark;
+
+typedef struct {
+  long states;              // states of the truncated chain
+  long transitions;         // nonzero off-diagonal rates of the generator
+  long sweeps;              // Gauss-Seidel sweeps until convergence
+  double residual;          // max |pi Q| of the solution
+  double boundary;          // probability of a full (or truncated) queue
+  int truncated;            // the queue is infinite and it has been truncated at CTMC_MAX_QUEUE
+} ctmc_analysis;
+
+typedef struct {
+  long observations;        // observations received
+  long groups;              // complete groups of WARMUP_MSER_BATCH observations
+  double partial;           // sum of the observations of the incomplete group
+  double *group_mean;       // mean of every complete group
+  long truncation;          // number of initial observations to discard
+} mser_state;
\ No newline at end of file
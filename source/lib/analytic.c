@@ -0,0 +1,271 @@
+/**
+* Erlang-C probability that an arrival waits in a M/M/c queue with offered load a = lambda/mu
+**/
+double erlang_c(int c, double a){
+  double term = 1, sum = 1, tail;
+
+  for(int n=1; n<c; n++){
+    term *= a / n;
+    sum += term;
+  }
+  tail = term * a / c / (1 - a / c);
+  return tail / (sum + tail);
+}
+
+/**
+* Steady state of a single M/M/c node (queue = INFINITE_CAPACITY) or M/M/c/K node (K = c + queue)
+**/
+void analytic_node(double rate, double mu, int c, unsigned long queue, statistic_analysis *result, int k){
+  double a = rate / mu, rho = rate / (c * mu), pn = 1, norm = 0, L = 0, Lq = 0, throughput, wq;
+  long capacity = c + queue;
+
+  if(queue == INFINITE_CAPACITY){
+    if(rho >= 1){
+      // unstable node: the queue grows without bound
+      result->interarrival[k][mean] = 1 / (c * mu);
+      result->wait[k][mean] = INFINITY;
+      result->delay[k][mean] = INFINITY;
+      result->Ns[k][mean] = INFINITY;
+      result->Nq[k][mean] = INFINITY;
+      result->utilization[k][mean] = 1;
+      result->ploss[k][mean] = 0;
+      result->service[k][mean] = 1 / mu;
+      return;
+    }
+    wq = erlang_c(c, a) / (c * mu - rate);
+    throughput = rate;
+    result->ploss[k][mean] = 0;
+    result->delay[k][mean] = wq;
+    result->wait[k][mean] = wq + 1 / mu;
+    result->Nq[k][mean] = rate * wq;
+    result->Ns[k][mean] = rate * (wq + 1 / mu);
+  }
+  else{
+    // birth-death chain truncated at the capacity, p(n) built with unnormalized terms
+    for(long n=0; n<=capacity; n++){
+      if(n > 0) pn *= n <= c ? a / n : rho;
+      norm += pn;
+      L += n * pn;
+      if(n > c) Lq += (n - c) * pn;
+    }
+    result->ploss[k][mean] = pn / norm;
+    throughput = rate * (1 - result->ploss[k][mean]);
+    result->Ns[k][mean] = L / norm;
+    result->Nq[k][mean] = Lq / norm;
+    result->wait[k][mean] = result->Ns[k][mean] / throughput;
+    result->delay[k][mean] = result->Nq[k][mean] / throughput;
+  }
+  result->interarrival[k][mean] = 1 / throughput;
+  result->service[k][mean] = 1 / mu;
+  result->utilization[k][mean] = throughput / (c * mu);
+}
+
+/**
+* Analytic solution of the network: traffic equations on the accepted flows and a product form of independent nodes
+**/
+void extract_analytic_analysis(double *external, route_table *routes, double *mu, int *servers, unsigned long *queue, statistic_analysis *result){
+  double routing[NODES][NODES], rate[NODES];
+
+  memset(result, 0, sizeof(statistic_analysis));
+  routing_matrix(routes, routing);
+
+  // the routing is feed-forward: a sweep for every node propagate the throughput of every node downstream
+  for(int sweep=0; sweep<nodes_num; sweep++){
+    for(int j=0; j<nodes_num; j++){
+      rate[j] = external[j];
+      for(int i=0; i<nodes_num; i++){
+        if(routing[i][j] > 0 && result->interarrival[i][mean] > 0) rate[j] += routing[i][j] / result->interarrival[i][mean];
+      }
+      analytic_node(rate[j], mu[j], servers[j], queue[j], result, j);
+    }
+  }
+  for(int k=0; k<nodes_num; k++) result->avg_max_wait[mean] += result->wait[k][mean];
+}
+
+/**
+* Class-wise solution of the non-preemptive priority M/M/c node with the same service rate for every class (Cobham)
+**/
+void extract_analytic_priority_analysis(statistic_analysis *result, node_id node, double mu, int c, double *probs, statistic_analysis *priority_result){
+  double rate = 1 / result->interarrival[node][mean], sigma = 0, previous, w0, other_waits = 0;
+
+  memset(priority_result, 0, sizeof(statistic_analysis));
+  w0 = erlang_c(c, rate / mu) / (c * mu);
+  for(int k=0; k<nodes_num; k++) if(k != (int) node) other_waits += result->wait[k][mean];
+
+  for(int i=0; i<PRIORITY_CLASSES; i++){
+    previous = sigma;
+    sigma += probs[i] * rate / (c * mu);
+    priority_result->interarrival[i][mean] = 1 / (probs[i] * rate);
+    priority_result->delay[i][mean] = sigma < 1 ? w0 / ((1 - previous) * (1 - sigma)) : INFINITY;
+    priority_result->service[i][mean] = 1 / mu;
+    priority_result->wait[i][mean] = priority_result->delay[i][mean] + 1 / mu;
+    priority_result->Ns[i][mean] = probs[i] * rate * priority_result->wait[i][mean];
+    priority_result->Nq[i][mean] = probs[i] * rate * priority_result->delay[i][mean];
+    priority_result->utilization[i][mean] = probs[i] * rate / (c * mu);
+    priority_result->priority_avg_max_wait[i][mean] = other_waits + priority_result->wait[i][mean];
+  }
+}
+
+/**
+* Decode a state of the priority chain: index < c means b busy servers and empty queue, otherwise c busy servers
+* and the pair (q1, q2) of queued jobs enumerated by total t = q1 + q2 (offset t(t+1)/2 + q1)
+**/
+void ctmc_state(long s, int c, int *busy, long *q1, long *q2){
+  long t = 0, offset;
+
+  if(s < c){
+    *busy = s;
+    *q1 = 0;
+    *q2 = 0;
+    return;
+  }
+  offset = s - c;
+  while((t + 1) * (t + 2) / 2 <= offset) t++;
+  *busy = c;
+  *q1 = offset - t * (t + 1) / 2;
+  *q2 = t - *q1;
+}
+
+long ctmc_index(int c, int busy, long q1, long q2){
+  long t = q1 + q2;
+  return busy < c ? busy : c + t * (t + 1) / 2 + q1;
+}
+
+/**
+* Transitions out of a state of the priority chain, returns their number (at most 3)
+**/
+int ctmc_transitions(long s, int c, long max_queue, double *lambdas, double mu, long *to, double *rates){
+  int busy, n = 0;
+  long q1, q2;
+
+  ctmc_state(s, c, &busy, &q1, &q2);
+  if(busy < c){
+    // any arrival finds a free server, any departure frees one
+    to[n] = ctmc_index(c, busy + 1, 0, 0);
+    rates[n++] = lambdas[0] + lambdas[1];
+    if(busy > 0){
+      to[n] = ctmc_index(c, busy - 1, 0, 0);
+      rates[n++] = busy * mu;
+    }
+    return n;
+  }
+  if(q1 + q2 < max_queue){
+    to[n] = ctmc_index(c, c, q1 + 1, q2);
+    rates[n++] = lambdas[0];
+    to[n] = ctmc_index(c, c, q1, q2 + 1);
+    rates[n++] = lambdas[1];
+  }
+  // non-preemptive priority: a departure takes the first job of the highest non-empty class into service
+  if(q1 > 0) to[n] = ctmc_index(c, c, q1 - 1, q2);
+  else if(q2 > 0) to[n] = ctmc_index(c, c, q1, q2 - 1);
+  else to[n] = ctmc_index(c, c - 1, 0, 0);
+  rates[n++] = c * mu;
+  return n;
+}
+
+/**
+* Class-wise solution of the non-preemptive priority M/M/c/K node: stationary distribution of the truncated CTMC
+* solved by Gauss-Seidel sweeps on the incoming transitions of every state
+**/
+void extract_ctmc_priority_analysis(statistic_analysis *result, node_id node, double mu, int c, unsigned long queue, double *probs, statistic_analysis *priority_result, ctmc_analysis *ctmc){
+  double rate = 1 / result->interarrival[node][mean] / (1 - result->ploss[node][mean]);
+  double lambdas[PRIORITY_CLASSES], rates[3], *pi, *out, *in_rate, nq[PRIORITY_CLASSES] = {0}, accepted, other_waits = 0, inflow, change, norm;
+  long max_queue = queue == INFINITE_CAPACITY ? CTMC_MAX_QUEUE : queue, to[3], *in_start, *in_from, *fill;
+  long q1, q2;
+  int busy, n;
+
+  memset(priority_result, 0, sizeof(statistic_analysis));
+  memset(ctmc, 0, sizeof(ctmc_analysis));
+  for(int i=0; i<PRIORITY_CLASSES; i++) lambdas[i] = probs[i] * rate;
+  ctmc->truncated = queue == INFINITE_CAPACITY;
+  ctmc->states = c + (max_queue + 1) * (max_queue + 2) / 2;
+
+  pi = calloc(ctmc->states, sizeof(double));
+  out = calloc(ctmc->states, sizeof(double));
+  in_start = calloc(ctmc->states + 1, sizeof(long));
+  fill = calloc(ctmc->states, sizeof(long));
+  if(pi == NULL || out == NULL || in_start == NULL || fill == NULL){
+    printf("Error allocating memory: priority CTMC\n");
+    exit(5);
+  }
+
+  // generator stored by destination: total outgoing rate of every state and list of its incoming transitions
+  for(long s=0; s<ctmc->states; s++){
+    n = ctmc_transitions(s, c, max_queue, lambdas, mu, to, rates);
+    for(int t=0; t<n; t++){
+      out[s] += rates[t];
+      in_start[to[t] + 1]++;
+    }
+    ctmc->transitions += n;
+  }
+  for(long s=0; s<ctmc->states; s++) in_start[s + 1] += in_start[s];
+  in_from = calloc(ctmc->transitions, sizeof(long));
+  in_rate = calloc(ctmc->transitions, sizeof(double));
+  if(in_from == NULL || in_rate == NULL){
+    printf("Error allocating memory: priority CTMC\n");
+    exit(5);
+  }
+  for(long s=0; s<ctmc->states; s++){
+    n = ctmc_transitions(s, c, max_queue, lambdas, mu, to, rates);
+    for(int t=0; t<n; t++){
+      in_from[in_start[to[t]] + fill[to[t]]] = s;
+      in_rate[in_start[to[t]] + fill[to[t]]++] = rates[t];
+    }
+  }
+
+  // initial guess: exact distribution of the total population (the aggregate M/M/c/K chain), split among the
+  // classes of the queued jobs as if they were served in FCFS order
+  for(long s=0; s<ctmc->states; s++){
+    ctmc_state(s, c, &busy, &q1, &q2);
+    pi[s] = 1;
+    for(long j=1; j<=busy + q1 + q2; j++) pi[s] *= rate / (mu * (j < c ? j : c));
+    for(long j=1; j<=q1 + q2; j++) pi[s] *= (j <= q1 ? lambdas[0] * (q2 + j) / j : lambdas[1]) / rate;
+  }
+
+  // Gauss-Seidel: pi(j) = sum_i pi(i) q(i,j) / q(j), using the values already updated in the current sweep
+  do{
+    change = 0;
+    norm = 0;
+    for(long s=0; s<ctmc->states; s++){
+      inflow = 0;
+      for(long t=in_start[s]; t<in_start[s + 1]; t++) inflow += pi[in_from[t]] * in_rate[t];
+      change = fmax(change, fabs(inflow / out[s] - pi[s]));
+      pi[s] = inflow / out[s];
+      norm += pi[s];
+    }
+    for(long s=0; s<ctmc->states; s++) pi[s] /= norm;
+    ctmc->sweeps++;
+  } while(change > CTMC_TOLERANCE && ctmc->sweeps < CTMC_MAX_SWEEPS);
+
+  for(long s=0; s<ctmc->states; s++){
+    inflow = 0;
+    for(long t=in_start[s]; t<in_start[s + 1]; t++) inflow += pi[in_from[t]] * in_rate[t];
+    ctmc->residual = fmax(ctmc->residual, fabs(inflow - pi[s] * out[s]));
+    ctmc_state(s, c, &busy, &q1, &q2);
+    nq[0] += q1 * pi[s];
+    nq[1] += q2 * pi[s];
+    if(busy == c && q1 + q2 == max_queue) ctmc->boundary += pi[s];
+  }
+
+  // Little's law on the accepted jobs of every class (arrivals see the time averages, PASTA)
+  for(int k=0; k<nodes_num; k++) if(k != (int) node) other_waits += result->wait[k][mean];
+  for(int i=0; i<PRIORITY_CLASSES; i++){
+    accepted = lambdas[i] * (1 - ctmc->boundary);
+    priority_result->interarrival[i][mean] = 1 / accepted;
+    priority_result->delay[i][mean] = nq[i] / accepted;
+    priority_result->service[i][mean] = 1 / mu;
+    priority_result->wait[i][mean] = priority_result->delay[i][mean] + 1 / mu;
+    priority_result->Nq[i][mean] = nq[i];
+    priority_result->Ns[i][mean] = nq[i] + accepted / mu;
+    priority_result->utilization[i][mean] = accepted / (c * mu);
+    priority_result->ploss[i][mean] = ctmc->truncated ? 0 : ctmc->boundary;
+    priority_result->priority_avg_max_wait[i][mean] = other_waits + priority_result->wait[i][mean];
+  }
+
+  free(pi);
+  free(out);
+  free(in_start);
+  free(in_from);
+  free(in_rate);
+  free(fill);
+}
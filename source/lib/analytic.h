@@ -0,0 +1,10 @@
+#include "analytic.c"
+
+double erlang_c(int, double);
+void analytic_node(double, double, int, unsigned long, statistic_analysis*, int);
+void extract_analytic_analysis(double*, route_table*, double*, int*, unsigned long*, statistic_analysis*);
+void extract_analytic_priority_analysis(statistic_analysis*, node_id, double, int, double*, statistic_analysis*);
+void ctmc_state(long, int, int*, long*, long*);
+long ctmc_index(int, int, long, long);
+int ctmc_transitions(long, int, long, double*, double, long*, double*);
+void extract_ctmc_priority_analysis(statistic_analysis*, node_id, double, int, unsigned long, double*, statistic_analysis*, ctmc_analysis*);
@@ -0,0 +1,193 @@
+/**
+* Stop on a malformed line of the CSV arrival log
+**/
+void log_error(char *filename, long line, char *message){
+  printf("Error in the arrival log %s at line %ld: %s\n", filename, line, message);
+  exit(0);
+}
+
+/**
+* Convert a CSV log of requests (time;entry node[;service at flight;hotel;taxi;payment_control]) to the binary format.
+* Times are rebased on the first request, an empty service is drawn from mu of the node during the replay
+**/
+void convert_arrival_log(char *csv_name, char *bin_name){
+  FILE *csv = fopen(csv_name, "r"), *bin;
+  char line[MODEL_MAX_LINE], tmpname[MODEL_MAX_LINE + 16], *field, *next, *end;
+  arrival_log_header header;
+  log_request request;
+  double first = 0, service[COMPILED_NODES];
+  long line_num = 0;
+  int fields;
+
+  if(csv == NULL){
+    printf("Error opening the arrival log: %s\n", csv_name);
+    exit(0);
+  }
+  snprintf(tmpname, sizeof(tmpname), "%s.%d", bin_name, (int)getpid());
+  bin = fopen(tmpname, "wb");
+  memset(&header, 0, sizeof(header));
+  memset(&request, 0, sizeof(request));
+  header.magic = ARRIVAL_LOG_MAGIC;
+  if(bin == NULL || fwrite(&header, sizeof(header), 1, bin) != 1){
+    printf("Error writing the arrival log: %s\n", tmpname);
+    exit(5);
+  }
+
+  while(fgets(line, sizeof(line), csv) != NULL){
+    line_num++;
+    line[strcspn(line, "#\r\n")] = '\0';
+    if(*trim_blanks(line) == '\0') continue;
+
+    // fields are separated by ';' or ','
+    fields = 0;
+    for(field = line; field != NULL; field = next){
+      next = strpbrk(field, ";,");
+      if(next != NULL) *next++ = '\0';
+      field = trim_blanks(field);
+      if(fields == 0){
+        request.time = strtod(field, &end);
+        if(end == field || *end != '\0'){
+          if(header.requests == 0) break;     // header row
+          log_error(csv_name, line_num, "expected the arrival time");
+        }
+      }
+      else if(fields == 1){
+        request.entry = model_node(field);
+        if(request.entry < 0 || request.entry >= COMPILED_NODES){
+          request.entry = (int) strtol(field, &end, 10);
+          if(end == field || *end != '\0' || request.entry < 0 || request.entry >= COMPILED_NODES) log_error(csv_name, line_num, "unknown entry node (flight, hotel, taxi, payment_control or 0-3)");
+        }
+      }
+      else if(fields <= COMPILED_NODES + 1){
+        service[fields - 2] = *field == '\0' ? -1 : strtod(field, &end);
+        if(*field != '\0' && (*end != '\0' || service[fields - 2] < 0)) log_error(csv_name, line_num, "service demands must be non negative numbers");
+      }
+      else log_error(csv_name, line_num, "too many fields");
+      fields++;
+    }
+    if(fields == 0) continue;
+    if(fields < 2) log_error(csv_name, line_num, "expected time and entry node");
+
+    // the first request decides if the log has the service demands
+    if(header.requests == 0){
+      header.services = fields > 2;
+      first = request.time;
+    }
+    if(header.services && fields != COMPILED_NODES + 2) log_error(csv_name, line_num, "expected a service demand (or an empty field) for every node");
+    if(!header.services && fields != 2) log_error(csv_name, line_num, "service demands must be in every request or in none");
+    request.time -= first;
+    if(request.time < header.span) log_error(csv_name, line_num, "requests must be sorted by time");
+    header.span = request.time;
+    header.entries[request.entry]++;
+    header.requests++;
+    if(fwrite(&request, sizeof(request), 1, bin) != 1 || (header.services && fwrite(service, sizeof(service), 1, bin) != 1)){
+      printf("Error writing the arrival log: %s\n", tmpname);
+      exit(5);
+    }
+  }
+  fclose(csv);
+
+  if(header.requests < ARRIVAL_LOG_MIN_REQUESTS || header.span <= 0){
+    fclose(bin);
+    remove(tmpname);
+    printf("Error in the arrival log %s: at least %d requests at different times are needed\n", csv_name, ARRIVAL_LOG_MIN_REQUESTS);
+    exit(0);
+  }
+  if(fseek(bin, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, bin) != 1 || fclose(bin) != 0 || rename(tmpname, bin_name) != 0){
+    printf("Error writing the arrival log: %s\n", tmpname);
+    remove(tmpname);
+    exit(5);
+  }
+  printf("Arrival log %s converted to %s (%ld requests)\n", csv_name, bin_name, header.requests);
+}
+
+/**
+* Map a binary arrival log for a sequential replay, a CSV log is converted first (again only if changed)
+**/
+void open_arrival_log(arrival_log *log, char *filename){
+  char bin_name[MODEL_MAX_LINE];
+  size_t len = strlen(filename);
+  struct stat csv_info, info;
+  arrival_log_header *header;
+  int fd;
+
+  memset(log, 0, sizeof(arrival_log));
+  snprintf(bin_name, sizeof(bin_name), "%s", filename);
+  if(len > 4 && strcmp(filename + len - 4, ".csv") == 0 && len < sizeof(bin_name)){
+    strcpy(bin_name + len - 4, ".bin");
+    if(stat(filename, &csv_info) != 0){
+      printf("Error opening the arrival log: %s\n", filename);
+      exit(0);
+    }
+    if(stat(bin_name, &info) != 0 || info.st_mtime < csv_info.st_mtime) convert_arrival_log(filename, bin_name);
+  }
+
+  fd = open(bin_name, O_RDONLY);
+  if(fd < 0 || fstat(fd, &info) != 0){
+    printf("Error opening the arrival log: %s\n", bin_name);
+    exit(0);
+  }
+  log->map_size = info.st_size;
+  log->map = info.st_size >= (off_t)sizeof(arrival_log_header) ? mmap(NULL, log->map_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  close(fd);
+  if(log->map == MAP_FAILED){
+    printf("Error mapping the arrival log: %s\n", bin_name);
+    exit(0);
+  }
+
+  // the requests are read once, in order: the kernel can read ahead and drop the pages already replayed
+  header = log->map;
+  log->header = *header;
+  log->stride = sizeof(log_request) + (header->services ? COMPILED_NODES * sizeof(double) : 0);
+  log->requests = (char*)(header + 1);
+  if(header->magic != ARRIVAL_LOG_MAGIC || header->requests < ARRIVAL_LOG_MIN_REQUESTS || header->span <= 0 ||
+    log->map_size != sizeof(arrival_log_header) + header->requests * log->stride){
+    printf("Error in the arrival log %s: not a binary arrival log (convert it from CSV)\n", bin_name);
+    exit(0);
+  }
+  madvise(log->map, log->map_size, MADV_SEQUENTIAL);
+}
+
+void close_arrival_log(arrival_log *log){
+  if(log->map != NULL) munmap(log->map, log->map_size);
+  memset(log, 0, sizeof(arrival_log));
+}
+
+/**
+* Length of a replay of the log: its span and the mean gap before it starts again
+**/
+double log_cycle(arrival_log *log){
+  return log->header.span * log->header.requests / (log->header.requests - 1);
+}
+
+/**
+* Rewind the log for a new replica
+**/
+void rewind_arrival_log(arrival_log *log, double start){
+  log->cursor = 0;
+  log->offset = start;
+}
+
+/**
+* Request to replay next, in place in the mapped file
+**/
+log_request *current_request(arrival_log *log){
+  return (log_request*)(log->requests + log->cursor * log->stride);
+}
+
+/**
+* Service demands of the request to replay next, NULL if the log has none
+**/
+double *request_services(arrival_log *log){
+  return log->header.services ? (double*)(current_request(log) + 1) : NULL;
+}
+
+/**
+* Move to the next request, the log starts again after its end
+**/
+void advance_arrival_log(arrival_log *log){
+  if(++log->cursor == log->header.requests){
+    log->cursor = 0;
+    log->offset += log_cycle(log);
+  }
+}
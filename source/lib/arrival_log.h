@@ -0,0 +1,11 @@
+#include "arrival_log.c"
+
+void log_error(char*, long, char*);
+void convert_arrival_log(char*, char*);
+void open_arrival_log(arrival_log*, char*);
+void close_arrival_log(arrival_log*);
+double log_cycle(arrival_log*);
+void rewind_arrival_log(arrival_log*, double);
+log_request *current_request(arrival_log*);
+double *request_services(arrival_log*);
+void advance_arrival_log(arrival_log*);
@@ -0,0 +1,84 @@
+/**
+* Rate of a segment of the profile at time t of the day
+**/
+double segment_rate(arrival_rates *rates, int s, double t){
+  if(!rates->linear) return rates->rate[s];
+  return rates->rate[s] + (rates->rate[s + 1] - rates->rate[s]) * (t - rates->time[s]) / (rates->time[s + 1] - rates->time[s]);
+}
+
+/**
+* Expected arrivals between two times of the same day (integral of the rate, exact on every segment)
+**/
+double rates_integral(arrival_rates *rates, double from, double to){
+  double total = 0, a, b;
+
+  for(int s=0; s<rates->points; s++){
+    a = fmax(from, rates->time[s]);
+    b = fmin(to, rates->time[s + 1]);
+    if(b > a) total += (b - a) * (segment_rate(rates, s, a) + segment_rate(rates, s, b)) / 2;
+  }
+  return total;
+}
+
+/**
+* Close the profile on the rate of the next day
+**/
+void close_arrival_rates(arrival_rates *rates){
+  rates->time[rates->points] = RATE_PERIOD;
+  rates->rate[rates->points] = rates->rate[0];
+}
+
+double mean_arrival_rate(arrival_rates *rates){
+  return rates_integral(rates, 0, RATE_PERIOD) / RATE_PERIOD;
+}
+
+/**
+* Start the profile again from the first segment, at the beginning of a replica
+**/
+void rewind_arrival_rates(arrival_rates *rates, double start){
+  rates->segment = 0;
+  rates->day = start;
+}
+
+/**
+* Next arrival after time by thinning with a bound for every piece of the profile: the candidates are exponential with the
+* bound of the piece and are accepted with probability rate/bound. A candidate beyond the piece restarts from its end
+* (memoryless), so a step profile is generated by inversion without rejections and a linear one only rejects the gap
+* between the rate and the larger rate at the ends of a piece of RATE_PIECE seconds
+**/
+double ThinnedArrival(arrival_rates *rates, double time){
+  int s;
+  double offset, end, piece, bound;
+
+  while(1){
+    while(time >= rates->day + rates->time[rates->segment + 1]){
+      if(++rates->segment == rates->points){
+        rates->segment = 0;
+        rates->day += RATE_PERIOD;
+      }
+    }
+    s = rates->segment;
+    offset = time - rates->day;
+    end = rates->time[s + 1];
+    bound = rates->rate[s];
+    if(rates->linear){
+      piece = rates->time[s] + RATE_PIECE * (floor((offset - rates->time[s]) / RATE_PIECE) + 1);
+      if(piece <= offset) piece += RATE_PIECE;
+      end = fmin(end, piece);
+      bound = fmax(segment_rate(rates, s, fmax(rates->time[s], piece - RATE_PIECE)), segment_rate(rates, s, end));
+    }
+    end += rates->day;
+    if(bound == 0){
+      time = end;
+      continue;
+    }
+    time += idfExponential(1.0/bound, Random());
+    if(time >= end){
+      time = end;
+      continue;
+    }
+    rates->candidates++;
+    if(!rates->linear || Random() * bound <= segment_rate(rates, s, time - rates->day)) return time;
+    rates->rejected++;
+  }
+}
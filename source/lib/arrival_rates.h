@@ -0,0 +1,8 @@
+#include "arrival_rates.c"
+
+double segment_rate(arrival_rates*, int, double);
+double rates_integral(arrival_rates*, double, double);
+void close_arrival_rates(arrival_rates*);
+double mean_arrival_rate(arrival_rates*);
+void rewind_arrival_rates(arrival_rates*, double);
+double ThinnedArrival(arrival_rates*, double);
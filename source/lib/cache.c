@@ -0,0 +1,344 @@
+/**
+* Mix a block of bytes into a FNV-1a hash
+**/
+unsigned long long hash_bytes(unsigned long long hash, void *data, size_t size){
+  unsigned char *byte = data;
+
+  for(size_t i=0; i<size; i++){
+    hash ^= byte[i];
+    hash *= CACHE_HASH_PRIME;
+  }
+  return hash;
+}
+
+/**
+* Open the cache file of a configuration, the cached records are available only if the stored key matches
+**/
+void open_cache(result_cache *cache, unsigned long long key){
+  cache_header header;
+
+  snprintf(cache->filename, sizeof(cache->filename), "analysis//cache//%016llx.bin", key);
+  memset(&cache->header, 0, sizeof(cache_header));
+  cache->header.key = key;
+
+  FILE *file = fopen(cache->filename, "rb");
+  if(file == NULL) return;
+  if(fread(&header, sizeof(cache_header), 1, file) == 1 && header.key == key) cache->header = header;
+  fclose(file);
+}
+
+/**
+* Write/read the scalar statistics and the server statistics of a single node (or priority class) record
+**/
+int write_record(FILE *file, analysis *record, int servers){
+  return fwrite(record, offsetof(analysis, server_utilization), 1, file) == 1 &&
+    fwrite(record->server_utilization, sizeof(double), servers, file) == (size_t)servers &&
+    fwrite(record->server_service, sizeof(double), servers, file) == (size_t)servers &&
+    fwrite(record->server_share, sizeof(double), servers, file) == (size_t)servers;
+}
+
+int read_record(FILE *file, analysis *record, int servers){
+  return fread(record, offsetof(analysis, server_utilization), 1, file) == 1 &&
+    fread(record->server_utilization, sizeof(double), servers, file) == (size_t)servers &&
+    fread(record->server_service, sizeof(double), servers, file) == (size_t)servers &&
+    fread(record->server_share, sizeof(double), servers, file) == (size_t)servers;
+}
+
+/**
+* Size of a replica/batch in the cache file, priority class records included
+**/
+long cache_record_size(int *servers, int priority_servers, int priority){
+  long size = 0;
+
+  for(int i=0; i<nodes_num; i++) size += offsetof(analysis, server_utilization) + 3 * servers[i] * sizeof(double);
+  if(priority) size += PRIORITY_CLASSES * (offsetof(analysis, server_utilization) + 3 * priority_servers * sizeof(double));
+  return size;
+}
+
+/**
+* Read the first n cached replicas/batches, return the number of records read
+**/
+long read_cached_records(result_cache *cache, analysis **result, analysis **priority_result, long n, int *servers, int priority_servers){
+  long records = cache->header.records < n ? cache->header.records : n;
+  FILE *file = fopen(cache->filename, "rb");
+
+  if(file == NULL || fseek(file, sizeof(cache_header), SEEK_SET) != 0) return 0;
+  for(long k=0; k<records; k++){
+    for(int i=0; i<nodes_num; i++){
+      if(!read_record(file, &result[k][i], servers[i])) records = 0;
+    }
+    for(int i=0; i<PRIORITY_CLASSES && cache->header.priority; i++){
+      if(!read_record(file, &priority_result[k][i], priority_servers)) records = 0;
+    }
+  }
+  fclose(file);
+  return records;
+}
+
+/**
+* Write/read the state of the nodes: counters, busy servers with their jobs and queued jobs
+**/
+int write_nodes(FILE *file, node_stats *nodes, int n){
+  int ok = fwrite(nodes, sizeof(node_stats), n, file) == (size_t)n;
+  long queued_jobs;
+
+  for(int i=0; i<n && ok; i++){
+    ok = fwrite(nodes[i].servers, sizeof(server_stats), nodes[i].total_servers, file) == (size_t)nodes[i].total_servers;
+    ok = ok && fwrite(nodes[i].totals, sizeof(server_totals), nodes[i].total_servers, file) == (size_t)nodes[i].total_servers;
+    for(int s=0; s<nodes[i].total_servers && ok; s++){
+      if(nodes[i].servers[s].status == busy && nodes[i].servers[s].serving_job != NULL) ok = fwrite(nodes[i].servers[s].serving_job, sizeof(job), 1, file) == 1;
+    }
+    // the priority classes only count the jobs queued in payment_control, their queue is empty
+    queued_jobs = 0;
+    for(job *queued = nodes[i].queue; queued != NULL; queued = queued->next) queued_jobs++;
+    ok = ok && fwrite(&queued_jobs, sizeof(long), 1, file) == 1;
+    for(job *queued = nodes[i].queue; queued != NULL && ok; queued = queued->next) ok = fwrite(queued, sizeof(job), 1, file) == 1;
+  }
+  return ok;
+}
+
+int read_nodes(FILE *file, node_stats *nodes, int n){
+  node_stats stored;
+  job buffer, **tail;
+  long queued_jobs;
+
+  for(int i=0; i<n; i++){
+    if(fread(&stored, sizeof(node_stats), 1, file) != 1 || stored.total_servers != nodes[i].total_servers) return 0;
+    stored.servers = nodes[i].servers;
+    stored.totals = nodes[i].totals;
+    stored.wait_derivative = nodes[i].wait_derivative;
+    stored.queue = NULL;
+    nodes[i] = stored;
+  }
+  for(int i=0; i<n; i++){
+    if(fread(nodes[i].servers, sizeof(server_stats), nodes[i].total_servers, file) != (size_t)nodes[i].total_servers) return 0;
+    if(fread(nodes[i].totals, sizeof(server_totals), nodes[i].total_servers, file) != (size_t)nodes[i].total_servers) return 0;
+    for(int s=0; s<nodes[i].total_servers; s++){
+      if(nodes[i].servers[s].status == busy && nodes[i].servers[s].serving_job != NULL){
+        if(fread(&buffer, sizeof(job), 1, file) != 1) return 0;
+        nodes[i].servers[s].serving_job = GenerateJob(buffer.arrival, buffer.service, buffer.priority);
+      }
+      else nodes[i].servers[s].serving_job = NULL;
+    }
+    tail = &nodes[i].queue;
+    if(fread(&queued_jobs, sizeof(long), 1, file) != 1) return 0;
+    for(long q=0; q<queued_jobs; q++){
+      if(fread(&buffer, sizeof(job), 1, file) != 1) return 0;
+      *tail = GenerateJob(buffer.arrival, buffer.service, buffer.priority);
+      tail = &(*tail)->next;
+    }
+  }
+  return 1;
+}
+
+/**
+* Store the first n replicas/batches and the state reached after them, written in a temporary file and then renamed
+**/
+void write_cache(result_cache *cache, analysis **result, analysis **priority_result, long n, int *servers, int priority_servers, cache_state *state){
+  char tmpname[72];
+  long streams[RNG_STREAMS], events = 0;
+  int ok;
+
+  cache->header.records = n;
+  cache->header.priority = priority_result != NULL;
+  cache->header.nodes = state->nodes != NULL;
+  snprintf(tmpname, sizeof(tmpname), "%s.tmp", cache->filename);
+  FILE *file = fopen(tmpname, "wb");
+  if(file == NULL){
+    printf("Error writing the result cache: %s\n", tmpname);
+    return;
+  }
+
+  ok = fwrite(&cache->header, sizeof(cache_header), 1, file) == 1;
+  for(long k=0; k<n && ok; k++){
+    for(int i=0; i<nodes_num && ok; i++) ok = write_record(file, &result[k][i], servers[i]);
+    for(int i=0; i<PRIORITY_CLASSES && ok && priority_result != NULL; i++) ok = write_record(file, &priority_result[k][i], priority_servers);
+  }
+
+  // the streams and the clock are enough to start the next replica, the next batch also needs the nodes and the events
+  save_streams(streams);
+  ok = ok && fwrite(streams, sizeof(long), RNG_STREAMS, file) == RNG_STREAMS;
+  ok = ok && fwrite(state->current_time, sizeof(double), 1, file) == 1;
+  ok = ok && fwrite(state->external_arrivals, sizeof(unsigned long), 1, file) == 1;
+  ok = ok && fwrite(state->first_arrival, sizeof(double), nodes_num, file) == (size_t)nodes_num;
+  if(state->nodes != NULL){
+    for(event *ev = *state->list; ev != NULL; ev = ev->next) events++;
+    ok = ok && fwrite(&events, sizeof(long), 1, file) == 1;
+    for(event *ev = *state->list; ev != NULL && ok; ev = ev->next) ok = fwrite(ev, sizeof(event), 1, file) == 1;
+    ok = ok && write_nodes(file, state->nodes, nodes_num);
+    ok = ok && fwrite(state->areas, sizeof(time_integrated), nodes_num, file) == (size_t)nodes_num;
+    if(priority_result != NULL){
+      ok = ok && write_nodes(file, state->priority_nodes, classes_num);
+      ok = ok && fwrite(state->priority_areas, sizeof(time_integrated), classes_num, file) == (size_t)classes_num;
+    }
+  }
+
+  if(fclose(file) != 0 || !ok || rename(tmpname, cache->filename) != 0){
+    printf("Error writing the result cache: %s\n", cache->filename);
+    remove(tmpname);
+  }
+}
+
+/**
+* Restore the state stored after the last cached replica/batch, so the run continues exactly as if it never stopped
+**/
+void read_cached_state(result_cache *cache, int *servers, int priority_servers, cache_state *state){
+  long streams[RNG_STREAMS], events;
+  event buffer, *ev, **tail;
+  int ok;
+
+  FILE *file = fopen(cache->filename, "rb");
+  ok = file != NULL && fseek(file, sizeof(cache_header) + cache->header.records * cache_record_size(servers, priority_servers, cache->header.priority), SEEK_SET) == 0;
+  ok = ok && fread(streams, sizeof(long), RNG_STREAMS, file) == RNG_STREAMS;
+  ok = ok && fread(state->current_time, sizeof(double), 1, file) == 1;
+  ok = ok && fread(state->external_arrivals, sizeof(unsigned long), 1, file) == 1;
+  ok = ok && fread(state->first_arrival, sizeof(double), nodes_num, file) == (size_t)nodes_num;
+  if(ok && state->nodes != NULL){
+    // the events scheduled by the initialization are replaced by the stored ones
+    while((ev = ExtractEvent(state->list)) != NULL) free(ev);
+    tail = state->list;
+    ok = fread(&events, sizeof(long), 1, file) == 1;
+    for(long e=0; e<events && ok; e++){
+      ok = fread(&buffer, sizeof(event), 1, file) == 1;
+      if(!ok) break;
+      *tail = GenerateEvent(buffer.type, buffer.node, buffer.server, buffer.time);
+      tail = &(*tail)->next;
+    }
+    ok = ok && read_nodes(file, state->nodes, nodes_num);
+    ok = ok && fread(state->areas, sizeof(time_integrated), nodes_num, file) == (size_t)nodes_num;
+    if(cache->header.priority){
+      ok = ok && read_nodes(file, state->priority_nodes, classes_num);
+      ok = ok && fread(state->priority_areas, sizeof(time_integrated), classes_num, file) == (size_t)classes_num;
+    }
+  }
+  if(file != NULL) fclose(file);
+  if(!ok){
+    printf("Error reading the result cache: %s\n", cache->filename);
+    exit(5);
+  }
+  restore_streams(streams);
+}
+
+/**
+* Unmap a replayed trace
+**/
+void close_trace(incremental_trace *trace){
+  if(trace->map != NULL) munmap(trace->map, trace->map_size);
+  trace->map = NULL;
+  trace->arrivals = NULL;
+  trace->upstream = NULL;
+}
+
+/**
+* Map the trace of the arrivals at payment_control recorded by a full simulation with the same upstream nodes
+**/
+int open_trace(incremental_trace *trace, unsigned long long key, long records){
+  struct stat info;
+  trace_header *header;
+  int fd;
+
+  memset(trace, 0, sizeof(incremental_trace));
+  snprintf(trace->filename, sizeof(trace->filename), "analysis//cache//trace_%016llx.bin", key);
+  fd = open(trace->filename, O_RDONLY);
+  if(fd < 0) return 0;
+  if(fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(trace_header)){
+    close(fd);
+    return 0;
+  }
+  trace->map_size = info.st_size;
+  trace->map = mmap(NULL, trace->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(trace->map == MAP_FAILED){
+    trace->map = NULL;
+    return 0;
+  }
+
+  // arrivals follow the header, the upstream statistics of every replica/batch follow the arrivals
+  header = trace->map;
+  if(header->key != key || header->records != records ||
+    trace->map_size != sizeof(trace_header) + header->arrivals * sizeof(trace_arrival) + records * payment_control * sizeof(trace_node)){
+    close_trace(trace);
+    return 0;
+  }
+  trace->header = *header;
+  trace->arrivals = (trace_arrival*)(header + 1);
+  trace->upstream = (trace_node*)(trace->arrivals + header->arrivals);
+  return 1;
+}
+
+/**
+* Start recording the arrivals at payment_control of a full simulation
+**/
+void start_trace(incremental_trace *trace, unsigned long long key, long records){
+  memset(trace, 0, sizeof(incremental_trace));
+  trace->header.key = key;
+  trace->header.records = records;
+  snprintf(trace->filename, sizeof(trace->filename), "analysis//cache//trace_%016llx.bin", key);
+  snprintf(trace->tmpname, sizeof(trace->tmpname), "%s.%d", trace->filename, (int)getpid());   // optimizer workers may record the same trace
+  trace->upstream = calloc(records * payment_control, sizeof(trace_node));
+  trace->file = fopen(trace->tmpname, "wb");
+  if(trace->upstream == NULL || trace->file == NULL || fwrite(&trace->header, sizeof(trace_header), 1, trace->file) != 1){
+    printf("Error recording the trace: %s\n", trace->tmpname);
+    exit(5);
+  }
+}
+
+void record_trace_arrival(incremental_trace *trace, double time, double service, int priority){
+  trace_arrival arrival = {time, service, priority};
+
+  if(fwrite(&arrival, sizeof(trace_arrival), 1, trace->file) != 1){
+    printf("Error recording the trace: %s\n", trace->tmpname);
+    exit(5);
+  }
+  trace->header.arrivals++;
+}
+
+/**
+* Close a replica/batch of the trace: the marker holds its end time, the upstream nodes their statistics
+**/
+void record_trace_marker(incremental_trace *trace, long k, double time, node_stats *nodes, time_integrated *areas){
+  trace_node *upstream = &trace->upstream[k * payment_control];
+
+  record_trace_arrival(trace, time, 0, -1);
+  for(int i=0; i<payment_control; i++){
+    upstream[i].processed_jobs = nodes[i].processed_jobs;
+    upstream[i].rejected_jobs = nodes[i].rejected_jobs;
+    upstream[i].last_arrival = nodes[i].last_arrival;
+    upstream[i].area = areas[i];
+    for(int s=0; s<nodes[i].total_servers; s++){
+      upstream[i].service_time[s] = nodes[i].totals[s].service_time;
+      upstream[i].served_jobs[s] = nodes[i].totals[s].served_jobs;
+    }
+  }
+}
+
+void finish_trace(incremental_trace *trace){
+  int ok = fwrite(trace->upstream, sizeof(trace_node), trace->header.records * payment_control, trace->file) == (size_t)(trace->header.records * payment_control);
+
+  ok = ok && fseek(trace->file, 0, SEEK_SET) == 0 && fwrite(&trace->header, sizeof(trace_header), 1, trace->file) == 1;
+  if(fclose(trace->file) != 0 || !ok || rename(trace->tmpname, trace->filename) != 0){
+    printf("Error recording the trace: %s\n", trace->filename);
+    remove(trace->tmpname);
+  }
+  free(trace->upstream);
+  trace->upstream = NULL;
+  trace->file = NULL;
+}
+
+/**
+* Copy the recorded statistics of the upstream nodes at the end of a replica/batch
+**/
+void restore_upstream(incremental_trace *trace, long k, node_stats *nodes, time_integrated *areas){
+  trace_node *upstream = &trace->upstream[k * payment_control];
+
+  for(int i=0; i<payment_control; i++){
+    nodes[i].processed_jobs = upstream[i].processed_jobs;
+    nodes[i].rejected_jobs = upstream[i].rejected_jobs;
+    nodes[i].last_arrival = upstream[i].last_arrival;
+    areas[i] = upstream[i].area;
+    for(int s=0; s<nodes[i].total_servers; s++){
+      nodes[i].totals[s].service_time = upstream[i].service_time[s];
+      nodes[i].totals[s].served_jobs = upstream[i].served_jobs[s];
+    }
+  }
+}
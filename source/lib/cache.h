@@ -0,0 +1,19 @@
+#include "cache.c"
+
+unsigned long long hash_bytes(unsigned long long, void*, size_t);
+void open_cache(result_cache*, unsigned long long);
+int write_record(FILE*, analysis*, int);
+int read_record(FILE*, analysis*, int);
+long cache_record_size(int*, int, int);
+long read_cached_records(result_cache*, analysis**, analysis**, long, int*, int);
+int write_nodes(FILE*, node_stats*, int);
+int read_nodes(FILE*, node_stats*, int);
+void write_cache(result_cache*, analysis**, analysis**, long, int*, int, cache_state*);
+void read_cached_state(result_cache*, int*, int, cache_state*);
+void close_trace(incremental_trace*);
+int open_trace(incremental_trace*, unsigned long long, long);
+void start_trace(incremental_trace*, unsigned long long, long);
+void record_trace_arrival(incremental_trace*, double, double, int);
+void record_trace_marker(incremental_trace*, long, double, node_stats*, time_integrated*);
+void finish_trace(incremental_trace*);
+void restore_upstream(incremental_trace*, long, node_stats*, time_integrated*);
@@ -0,0 +1,661 @@
+/**
+* Initialize the MSER state for at most max_obs observations
+**/
+void init_mser(mser_state *state, long max_obs){
+  state->observations = 0;
+  state->groups = 0;
+  state->partial = 0;
+  state->truncation = 0;
+  state->group_mean = calloc(max_obs / WARMUP_MSER_BATCH + 1, sizeof(double));
+  if(state->group_mean == NULL){
+    printf("Error allocating memory for: mser_state\n");
+    exit(6);
+  }
+}
+
+/**
+* Add a new observation and update the MSER-m truncation point (m = WARMUP_MSER_BATCH)
+**/
+void mser_update(mser_state *state, double obs){
+  double sum = 0, square_sum = 0, mser, best = -1;
+
+  state->observations++;
+  state->partial += obs;
+  if(state->observations % WARMUP_MSER_BATCH != 0) return;
+
+  state->group_mean[state->groups] = state->partial / WARMUP_MSER_BATCH;
+  state->groups++;
+  state->partial = 0;
+
+  // MSER(d) = sum_{j>=d} (Z_j - mean_d)^2 / (n-d)^2, computed from the suffix sums (at least 2 groups kept)
+  for(long d=state->groups-1; d>=0; d--){
+    sum += state->group_mean[d];
+    square_sum += state->group_mean[d] * state->group_mean[d];
+
+    long n = state->groups - d;
+    if(n < 2) continue;
+    mser = (square_sum - sum * sum / n) / ((double) n * n);
+    if(best < 0 || mser <= best){
+      best = mser;
+      state->truncation = d * WARMUP_MSER_BATCH;
+    }
+  }
+}
+
+/**
+* Check if the truncation point is reliable (it must fall in the first half of the observations)
+**/
+int mser_stable(mser_state *state){
+  return state->groups >= WARMUP_MIN_GROUPS && 2 * state->truncation <= state->observations;
+}
+
+/**
+* Free the MSER state
+**/
+void free_mser(mser_state *state){
+  free(state->group_mean);
+  state->group_mean = NULL;
+}
+
+/**
+* Compute the lag-1 autocorrelation of a series
+**/
+double lag1_autocorrelation(double *x, long n){
+  double mean = 0, variance = 0, covariance = 0;
+
+  for(long i=0; i<n; i++) mean += x[i] / n;
+  for(long i=0; i<n; i++){
+    variance += (x[i] - mean) * (x[i] - mean);
+    if(i > 0) covariance += (x[i-1] - mean) * (x[i] - mean);
+  }
+  if(variance == 0) return 0;
+
+  return covariance / variance;
+}
+
+/**
+* Test (one-sided, level ADAPTIVE_ALPHA) that the batch means of response time, ploss and node waits are uncorrelated
+**/
+int batches_uncorrelated(analysis **result, long n){
+  double bound = idfNormal(0.0, 1.0, 1.0 - ADAPTIVE_ALPHA) / sqrt(n);
+  double *series = calloc(n, sizeof(double));
+  int passed = 1;
+
+  if(series == NULL){
+    printf("Error allocating memory: autocorrelation series\n");
+    exit(6);
+  }
+
+  for(long k=0; k<n; k++) series[k] = get_response_time(result[k]);
+  if(lag1_autocorrelation(series, n) > bound) passed = 0;
+
+  for(long k=0; k<n; k++) series[k] = result[k][payment_control].ploss;
+  if(lag1_autocorrelation(series, n) > bound) passed = 0;
+
+  for(int i=0; i<nodes_num; i++){
+    for(long k=0; k<n; k++) series[k] = result[k][i].wait;
+    if(lag1_autocorrelation(series, n) > bound) passed = 0;
+  }
+
+  free(series);
+  return passed;
+}
+
+/**
+* Enlarge the stream of per-interval sums to hold capacity intervals
+**/
+void grow_interval_stream(interval_stream *stream, long capacity){
+  stream->capacity = capacity;
+  stream->node_area = realloc(stream->node_area, capacity * nodes_num * sizeof(float));
+  stream->queue_area = realloc(stream->queue_area, capacity * nodes_num * sizeof(float));
+  stream->processed = realloc(stream->processed, capacity * nodes_num * sizeof(float));
+  stream->rejected = realloc(stream->rejected, capacity * nodes_num * sizeof(float));
+  stream->service = realloc(stream->service, capacity * nodes_num * sizeof(float));
+  stream->duration = realloc(stream->duration, capacity * sizeof(float));
+  if(stream->node_area == NULL || stream->queue_area == NULL || stream->processed == NULL || stream->rejected == NULL || stream->service == NULL || stream->duration == NULL){
+    printf("Error allocating memory for: interval_stream\n");
+    exit(6);
+  }
+}
+
+/**
+* Initialize the stream of per-interval sums, with room for capacity intervals
+**/
+void init_interval_stream(interval_stream *stream, long capacity, double start){
+  memset(stream, 0, sizeof(interval_stream));
+  stream->last_time = start;
+  grow_interval_stream(stream, capacity);
+}
+
+/**
+* Append the sums of the last interval, computed as difference from the previous cumulative values
+**/
+void record_interval(interval_stream *stream, node_stats *nodes, time_integrated *areas, double time){
+  long n = stream->intervals;
+  double service;
+
+  if(n >= stream->capacity) grow_interval_stream(stream, 2 * stream->capacity);
+  for(int i=0; i<nodes_num; i++){
+    service = 0;
+    for(int s=0; s<nodes[i].total_servers; s++) service += nodes[i].totals[s].service_time;
+    stream->node_area[n*nodes_num + i] = areas[i].node_area - stream->last_node_area[i];
+    stream->queue_area[n*nodes_num + i] = areas[i].queue_area - stream->last_queue_area[i];
+    stream->processed[n*nodes_num + i] = nodes[i].processed_jobs - stream->last_processed[i];
+    stream->rejected[n*nodes_num + i] = nodes[i].rejected_jobs - stream->last_rejected[i];
+    stream->service[n*nodes_num + i] = service - stream->last_service[i];
+    stream->last_node_area[i] = areas[i].node_area;
+    stream->last_queue_area[i] = areas[i].queue_area;
+    stream->last_processed[i] = nodes[i].processed_jobs;
+    stream->last_rejected[i] = nodes[i].rejected_jobs;
+    stream->last_service[i] = service;
+  }
+  stream->duration[n] = time - stream->last_time;
+  stream->last_time = time;
+  stream->intervals++;
+}
+
+/**
+* Restart the cumulative values after the node statistics are reset at the end of a batch
+**/
+void reset_interval_snapshot(interval_stream *stream){
+  for(int i=0; i<nodes_num; i++){
+    stream->last_node_area[i] = 0;
+    stream->last_queue_area[i] = 0;
+    stream->last_processed[i] = 0;
+    stream->last_rejected[i] = 0;
+    stream->last_service[i] = 0;
+  }
+}
+
+/**
+* Free the stream of per-interval sums
+**/
+void free_interval_stream(interval_stream *stream){
+  free(stream->node_area);
+  free(stream->queue_area);
+  free(stream->processed);
+  free(stream->rejected);
+  free(stream->service);
+  free(stream->duration);
+}
+
+/**
+* Weight of lag k in the Bartlett or Parzen spectral window with truncation lag M
+**/
+double spectral_weight(variance_estimator window, long k, long M){
+  double x = (double) k / M;
+
+  if(x >= 1) return 0;
+  if(window == spectral_bartlett) return 1 - x;
+  if(x <= 0.5) return 1 - 6*x*x + 6*x*x*x;
+  return 2 * (1-x) * (1-x) * (1-x);
+}
+
+/**
+* Estimate mean and confidence interval of a series with non-overlapping batch means, overlapping batch means (batch size m) and spectral windows (truncation lag M)
+**/
+void estimate_variance(double *y, long n, long m, long M, double estimate[VARIANCE_ESTIMATORS][2]){
+  double u = 1.0 - (1.0 - LOC)/2;
+  double ybar = 0, sum, batch, variance, df, gamma;
+  long b = n / m;
+
+  for(long i=0; i<n; i++) ybar += y[i] / n;
+  for(int e=0; e<VARIANCE_ESTIMATORS; e++){
+    estimate[e][mean] = ybar;
+    estimate[e][interval] = 0;
+  }
+  if(b < 2 || M >= n) return;
+
+  // non-overlapping batch means on the first b*m values
+  sum = 0;
+  double bm_mean = 0;
+  for(long j=0; j<b; j++){
+    batch = 0;
+    for(long i=j*m; i<(j+1)*m; i++) batch += y[i] / m;
+    bm_mean += batch / b;
+    sum += batch * batch;
+  }
+  variance = (sum - b * bm_mean * bm_mean) / (b - 1);
+  estimate[batch_means][interval] = idfStudent(b - 1, u) * sqrt(variance / b);
+
+  // overlapping batch means: every window of m consecutive values, updated in O(1)
+  sum = 0;
+  batch = 0;
+  for(long i=0; i<m; i++) batch += y[i];
+  for(long j=0; j+m<=n; j++){
+    if(j > 0) batch += y[j+m-1] - y[j-1];
+    sum += (batch / m - ybar) * (batch / m - ybar);
+  }
+  variance = n * (double) m / ((n - m + 1.0) * (n - m)) * sum;
+  df = floor(1.5 * (n / (double) m - 1));
+  estimate[overlapping_batch_means][interval] = idfStudent(fmax(df, 1), u) * sqrt(variance / n);
+
+  // spectral estimators of the variance parameter with Bartlett and Parzen windows
+  for(int e=spectral_bartlett; e<=spectral_parzen; e++){
+    variance = 0;
+    for(long k=0; k<M; k++){
+      gamma = 0;
+      for(long i=0; i+k<n; i++) gamma += (y[i] - ybar) * (y[i+k] - ybar);
+      gamma /= n;
+      variance += (k == 0 ? 1 : 2) * spectral_weight(e, k, M) * gamma;
+    }
+    df = floor((e == spectral_bartlett ? 1.5 : 3.709) * n / M);
+    estimate[e][interval] = idfStudent(fmax(df, 1), u) * sqrt(fmax(variance, 0) / n);
+  }
+}
+
+/**
+* Extract node waits, populations, ploss and response time from the interval stream and compare the variance estimators
+**/
+void extract_variance_analysis(interval_stream *stream, variance_analysis *result, long batch_intervals){
+  long n = stream->intervals;
+  double *wait = calloc(n, sizeof(double)), *Ns = calloc(n, sizeof(double)), *ploss = calloc(n, sizeof(double)), *response = calloc(n, sizeof(double));
+  double processed, rejected;
+
+  if(wait == NULL || Ns == NULL || ploss == NULL || response == NULL){
+    printf("Error allocating memory: variance analysis series\n");
+    exit(6);
+  }
+  result->intervals = n;
+  result->batch_intervals = batch_intervals;
+
+  for(int i=0; i<nodes_num; i++){
+    for(long j=0; j<n; j++){
+      processed = stream->processed[j*nodes_num + i];
+      rejected = stream->rejected[j*nodes_num + i];
+      wait[j] = processed > 0 ? stream->node_area[j*nodes_num + i] / processed : 0;
+      Ns[j] = stream->node_area[j*nodes_num + i] / stream->duration[j];
+      ploss[j] = rejected + processed > 0 ? rejected / (rejected + processed) : 0;
+      response[j] += wait[j];
+    }
+    estimate_variance(wait, n, batch_intervals, SPECTRAL_LAGS, result->wait[i]);
+    estimate_variance(Ns, n, batch_intervals, SPECTRAL_LAGS, result->Ns[i]);
+    estimate_variance(ploss, n, batch_intervals, SPECTRAL_LAGS, result->ploss[i]);
+  }
+  estimate_variance(response, n, batch_intervals, SPECTRAL_LAGS, result->avg_max_wait);
+
+  free(wait);
+  free(Ns);
+  free(ploss);
+  free(response);
+}
+
+/**
+* Ratio estimator sum(y)/sum(x) over the regeneration cycles, with confidence interval from the residuals y - r*x
+**/
+void ratio_estimate(double *y, double *x, long n, double *estimate){
+  double u = 1.0 - (1.0 - LOC)/2;
+  double y_sum = 0, x_sum = 0, r, residual, variance = 0;
+
+  for(long i=0; i<n; i++){
+    y_sum += y[i];
+    x_sum += x[i];
+  }
+  r = x_sum > 0 ? y_sum / x_sum : 0;
+  for(long i=0; i<n; i++){
+    residual = y[i] - r * x[i];
+    variance += residual * residual / (n - 1);
+  }
+
+  estimate[mean] = r;
+  estimate[interval] = x_sum > 0 ? idfStudent(n - 1, u) * sqrt(variance / n) / (x_sum / n) : 0;
+}
+
+/**
+* Extract the steady state statistics from the regeneration cycles recorded in the stream
+**/
+void extract_regenerative_analysis(interval_stream *stream, statistic_analysis *result, int *servers_num){
+  long n = stream->intervals;
+  double u = 1.0 - (1.0 - LOC)/2;
+  double *y, *x, *length, *residual;
+  double x_mean, residual_mean = 0, variance = 0;
+
+  if(n < REGENERATIVE_MIN_CYCLES){
+    printf("ERROR - insufficient data: only %ld regeneration cycles observed\n", n);
+    exit(5);
+  }
+  y = calloc(n, sizeof(double));
+  x = calloc(n, sizeof(double));
+  length = calloc(n, sizeof(double));
+  residual = calloc(n, sizeof(double));
+  if(y == NULL || x == NULL || residual == NULL || length == NULL){
+    printf("Error allocating memory: regenerative analysis\n");
+    exit(6);
+  }
+  result->samples = n;
+  result->warmup = -1;
+  result->batch_size = 0;
+  result->antithetic = 0;
+  result->avg_max_wait[mean] = 0;
+
+  for(long j=0; j<n; j++) length[j] = stream->duration[j];
+  for(int i=0; i<nodes_num; i++){
+    // jobs processed in every cycle are the denominator of the per-job metrics
+    x_mean = 0;
+    for(long j=0; j<n; j++){
+      x[j] = stream->processed[j*nodes_num + i];
+      x_mean += x[j] / n;
+    }
+    ratio_estimate(length, x, n, result->interarrival[i]);
+
+    for(long j=0; j<n; j++) y[j] = stream->node_area[j*nodes_num + i];
+    ratio_estimate(y, x, n, result->wait[i]);
+    ratio_estimate(y, length, n, result->Ns[i]);
+
+    // the response time is a sum of ratios: the linearized residuals of every node wait are added up
+    result->avg_max_wait[mean] += result->wait[i][mean];
+    for(long j=0; j<n; j++) residual[j] += (y[j] - result->wait[i][mean] * x[j]) / x_mean;
+
+    for(long j=0; j<n; j++) y[j] = stream->queue_area[j*nodes_num + i];
+    ratio_estimate(y, x, n, result->delay[i]);
+    ratio_estimate(y, length, n, result->Nq[i]);
+
+    for(long j=0; j<n; j++) y[j] = stream->service[j*nodes_num + i];
+    ratio_estimate(y, x, n, result->service[i]);
+    ratio_estimate(y, length, n, result->utilization[i]);
+    result->utilization[i][mean] /= servers_num[i];
+    result->utilization[i][interval] /= servers_num[i];
+
+    // offered jobs (processed + rejected) are the denominator of ploss
+    for(long j=0; j<n; j++){
+      y[j] = stream->rejected[j*nodes_num + i];
+      x[j] += y[j];
+    }
+    ratio_estimate(y, x, n, result->ploss[i]);
+  }
+
+  for(long j=0; j<n; j++) residual_mean += residual[j] / n;
+  for(long j=0; j<n; j++) variance += (residual[j] - residual_mean) * (residual[j] - residual_mean) / (n - 1);
+  result->avg_max_wait[interval] = idfStudent(n - 1, u) * sqrt(variance / n);
+
+  free(y);
+  free(x);
+  free(length);
+  free(residual);
+}
+
+/**
+* Solve the n x n linear system a*x = b with gaussian elimination and partial pivoting, x is returned in b
+**/
+int solve_linear_system(double *a, double *b, int n){
+  double factor, tmp;
+  int pivot;
+
+  for(int k=0; k<n; k++){
+    pivot = k;
+    for(int i=k+1; i<n; i++) if(fabs(a[i*n + k]) > fabs(a[pivot*n + k])) pivot = i;
+    if(fabs(a[pivot*n + k]) < 1e-12) return 0;
+    if(pivot != k){
+      for(int j=0; j<n; j++){
+        tmp = a[k*n + j];
+        a[k*n + j] = a[pivot*n + j];
+        a[pivot*n + j] = tmp;
+      }
+      tmp = b[k];
+      b[k] = b[pivot];
+      b[pivot] = tmp;
+    }
+    for(int i=k+1; i<n; i++){
+      factor = a[i*n + k] / a[k*n + k];
+      for(int j=k; j<n; j++) a[i*n + j] -= factor * a[k*n + j];
+      b[i] -= factor * b[k];
+    }
+  }
+  for(int k=n-1; k>=0; k--){
+    for(int j=k+1; j<n; j++) b[k] -= a[k*n + j] * b[j];
+    b[k] /= a[k*n + k];
+  }
+  return 1;
+}
+
+/**
+* Regress y on q zero-mean controls (least squares with intercept): the intercept is the adjusted estimate
+* and its standard error gives the confidence interval with n - q - 1 degrees of freedom.
+* Without enough samples or with collinear controls the raw mean and interval are returned
+**/
+void control_variate_estimate(double *y, double *controls, long n, int q, double *estimate){
+  double u = 1.0 - (1.0 - LOC)/2;
+  int p = q + 1;
+  double *xtx = calloc(p * p, sizeof(double));
+  double *xty = calloc(p, sizeof(double));
+  double *inverse = calloc(p, sizeof(double));
+  double *copy = calloc(p * p, sizeof(double));
+  double *x = calloc(p, sizeof(double));
+  double ybar = 0, variance = 0, residual, sse = 0;
+
+  if(xtx == NULL || xty == NULL || inverse == NULL || copy == NULL || x == NULL){
+    printf("Error allocating memory: control variates\n");
+    exit(6);
+  }
+  for(long j=0; j<n; j++) ybar += y[j] / n;
+  for(long j=0; j<n; j++) variance += (y[j] - ybar) * (y[j] - ybar) / (n - 1);
+  estimate[mean] = ybar;
+  estimate[interval] = idfStudent(n - 1, u) * sqrt(variance / n);
+
+  if(n > p + 1){
+    for(long j=0; j<n; j++){
+      x[0] = 1;
+      for(int c=0; c<q; c++) x[c+1] = controls[j*q + c];
+      for(int r=0; r<p; r++){
+        xty[r] += x[r] * y[j];
+        for(int c=0; c<p; c++) xtx[r*p + c] += x[r] * x[c];
+      }
+    }
+    inverse[0] = 1;
+    memcpy(copy, xtx, p * p * sizeof(double));
+    // coefficients and first column of the inverse of X'X (variance of the intercept)
+    if(solve_linear_system(xtx, xty, p) && solve_linear_system(copy, inverse, p)){
+      for(long j=0; j<n; j++){
+        residual = y[j] - xty[0];
+        for(int c=0; c<q; c++) residual -= xty[c+1] * controls[j*q + c];
+        sse += residual * residual;
+      }
+      estimate[mean] = xty[0];
+      estimate[interval] = idfStudent(n - p, u) * sqrt(sse / (n - p) * inverse[0]);
+    }
+  }
+
+  free(xtx);
+  free(xty);
+  free(inverse);
+  free(copy);
+  free(x);
+}
+
+/**
+* Extract the control-variate adjusted estimators: the metrics of every node are regressed on the controls of the node,
+* the response time on the controls of all the nodes
+**/
+void extract_control_variate_analysis(analysis **result, long n, double *expected_interarrival, double *expected_service, control_variate_analysis *cv_result){
+  double *y = calloc(n, sizeof(double));
+  double *controls = calloc(n * nodes_num * NODE_CONTROLS, sizeof(double));
+  double *node_controls = calloc(n * NODE_CONTROLS, sizeof(double));
+
+  if(y == NULL || controls == NULL || node_controls == NULL){
+    printf("Error allocating memory: control variates\n");
+    exit(6);
+  }
+  cv_result->samples = n;
+
+  // the offered interarrival (before rejections) has the expected value given by the traffic equations
+  for(long j=0; j<n; j++){
+    for(int i=0; i<nodes_num; i++){
+      controls[(j*nodes_num + i)*NODE_CONTROLS] = result[j][i].service - expected_service[i];
+      controls[(j*nodes_num + i)*NODE_CONTROLS + 1] = result[j][i].interarrival * (1 - result[j][i].ploss) - expected_interarrival[i];
+    }
+  }
+
+  for(int i=0; i<nodes_num; i++){
+    for(long j=0; j<n; j++){
+      for(int c=0; c<NODE_CONTROLS; c++) node_controls[j*NODE_CONTROLS + c] = controls[(j*nodes_num + i)*NODE_CONTROLS + c];
+    }
+    for(long j=0; j<n; j++) y[j] = result[j][i].wait;
+    control_variate_estimate(y, node_controls, n, NODE_CONTROLS, cv_result->wait[i]);
+    for(long j=0; j<n; j++) y[j] = result[j][i].delay;
+    control_variate_estimate(y, node_controls, n, NODE_CONTROLS, cv_result->delay[i]);
+    for(long j=0; j<n; j++) y[j] = result[j][i].Ns;
+    control_variate_estimate(y, node_controls, n, NODE_CONTROLS, cv_result->Ns[i]);
+    for(long j=0; j<n; j++) y[j] = result[j][i].ploss;
+    control_variate_estimate(y, node_controls, n, NODE_CONTROLS, cv_result->ploss[i]);
+  }
+
+  for(long j=0; j<n; j++) y[j] = get_response_time(result[j]);
+  control_variate_estimate(y, controls, n, nodes_num * NODE_CONTROLS, cv_result->avg_max_wait);
+
+  free(y);
+  free(controls);
+  free(node_controls);
+}
+
+/**
+* Update mean ([0]) and sum of squared deviations ([1]) of a sample with Welford's one-pass method
+**/
+void welford_update(double *accumulator, long n, double x){
+  double diff = x - accumulator[mean];
+  accumulator[mean] += diff / n;
+  accumulator[interval] += diff * (x - accumulator[mean]);
+}
+
+/**
+* Extract mean and confidence interval of the IPA derivatives of the replicas/batches:
+* the derivative of the response time is the sum of the derivatives of the waits
+**/
+void extract_gradient_analysis(gradient_sample *samples, long n, gradient_analysis *result){
+  double u = 1.0 - (1.0 - LOC)/2;
+  double t = idfStudent(n - 1, u);
+  double response;
+
+  memset(result, 0, sizeof(gradient_analysis));
+  result->samples = n;
+  for(long j=0; j<n; j++){
+    for(int i=0; i<IPA_PARAMETERS; i++){
+      response = 0;
+      for(int k=0; k<nodes_num; k++){
+        welford_update(result->wait[k][i], j + 1, samples[j].wait[k][i]);
+        response += samples[j].wait[k][i];
+      }
+      welford_update(result->avg_max_wait[i], j + 1, response);
+    }
+  }
+
+  // the second accumulator holds the sum of squared deviations until here
+  for(int i=0; i<IPA_PARAMETERS; i++){
+    for(int k=0; k<nodes_num; k++) result->wait[k][i][interval] = t * sqrt(result->wait[k][i][interval] / (n - 1)) / sqrt(n);
+    result->avg_max_wait[i][interval] = t * sqrt(result->avg_max_wait[i][interval] / (n - 1)) / sqrt(n);
+  }
+}
+
+/**
+* Update the accumulators of a plain payment_control cycle
+**/
+void record_plain_cycle(rare_event_analysis *result, long arrivals, long rejections, long excursions){
+  double arrivals_diff = arrivals - result->arrivals[mean];
+
+  result->plain_cycles++;
+  welford_update(result->rejections, result->plain_cycles, rejections);
+  result->comoment += arrivals_diff * (rejections - result->rejections[mean]);
+  welford_update(result->excursions, result->plain_cycles, excursions);
+  result->excursion_comoment += arrivals_diff * (excursions - result->excursions[mean]);
+  welford_update(result->arrivals, result->plain_cycles, arrivals);
+}
+
+/**
+* Update the accumulators of an excursion of a tilted cycle with all the payment_control servers busy
+**/
+void record_tilted_excursion(rare_event_analysis *result, long rejections, double likelihood){
+  result->tilted_excursions++;
+  welford_update(result->weighted, result->tilted_excursions, rejections * likelihood);
+}
+
+/**
+* Compute crude and importance sampling ploss as ratios of cycle means, with delta-method confidence intervals
+**/
+void extract_rare_event_analysis(rare_event_analysis *result){
+  double u = 1.0 - (1.0 - LOC)/2;
+  long n_p = result->plain_cycles, n_t = result->tilted_excursions;
+  double var_a, var_r, var_e, var_w, cov, cov_e, r, w, e, a;
+
+  if(n_p < RARE_EVENT_MIN_CYCLES || n_t < RARE_EVENT_MIN_CYCLES){
+    printf("ERROR - insufficient data: %ld plain cycles and %ld tilted excursions observed\n", n_p, n_t);
+    exit(5);
+  }
+  var_a = result->arrivals[interval] / (n_p - 1);
+  var_r = result->rejections[interval] / (n_p - 1);
+  var_e = result->excursions[interval] / (n_p - 1);
+  cov = result->comoment / (n_p - 1);
+  cov_e = result->excursion_comoment / (n_p - 1);
+  var_w = result->weighted[interval] / (n_t - 1);
+
+  // crude: rejections and arrivals come from the same cycles
+  r = result->rejections[mean] / result->arrivals[mean];
+  result->plain_ploss[mean] = r;
+  result->plain_ploss[interval] = idfStudent(n_p - 1, u) * sqrt(fmax(var_r - 2 * r * cov + r * r * var_a, 0) / n_p) / result->arrivals[mean];
+
+  // importance sampling: the excursions of a cycle start all alike, so by Wald's identity the rejections per cycle are
+  // the excursions per cycle (plain cycles) times the rejections per excursion (tilted excursions, independent of the plain cycles)
+  w = result->weighted[mean];
+  e = result->excursions[mean];
+  a = result->arrivals[mean];
+  r = w * e / a;
+  result->ploss[mean] = r;
+  result->ploss[interval] = idfStudent((n_p < n_t ? n_p : n_t) - 1, u) * sqrt(e * e * var_w / n_t + fmax(w * w * var_e - 2 * w * r * cov_e + r * r * var_a, 0) / n_p) / a;
+}
+
+/**
+* Kim-Nelson constant h^2 of k systems with n0 first-stage observations and probability of correct selection pcs
+**/
+double kn_parameter(int k, long n0, double pcs){
+  double eta = 0.5 * (pow(2 * (1 - pcs) / (k - 1), -2.0 / (n0 - 1)) - 1);
+  return 2 * eta * (n0 - 1);
+}
+
+/**
+* First-stage sample variances of the pairwise differences, obs[i*stride + r] is observation r of system i
+**/
+void kn_variances(double *obs, long stride, int k, long n0, double *S2){
+  double diff, mean_diff, sum;
+
+  for(int i=0; i<k; i++){
+    for(int l=0; l<k; l++){
+      mean_diff = 0;
+      sum = 0;
+      for(long r=1; r<=n0; r++){
+        diff = obs[i*stride + r-1] - obs[l*stride + r-1] - mean_diff;
+        sum += diff * diff * (r - 1.0) / r;
+        mean_diff += diff / r;
+      }
+      S2[i*k + l] = sum / (n0 - 1);
+    }
+  }
+}
+
+/**
+* Eliminate the systems whose mean exceeds another mean by more than the KN continuation region after r observations
+**/
+int kn_screen(double *obs, long stride, int k, long r, double *S2, double h2, double delta, long *eliminated){
+  double *means = calloc(k, sizeof(double));
+  double w;
+  int alive = 0;
+
+  if(means == NULL){
+    printf("Error allocating memory: ranking and selection\n");
+    exit(5);
+  }
+  for(int i=0; i<k; i++){
+    for(long n=0; n<r && !eliminated[i]; n++) means[i] += obs[i*stride + n] / r;
+  }
+  for(int i=0; i<k; i++){
+    if(eliminated[i]) continue;
+    for(int l=0; l<k; l++){
+      if(l == i || (eliminated[l] && eliminated[l] < r)) continue;
+      w = fmax(0, delta / (2 * r) * (h2 * S2[i*k + l] / (delta * delta) - r));
+      if(means[i] > means[l] + w){
+        eliminated[i] = r;
+        break;
+      }
+    }
+  }
+  for(int i=0; i<k; i++) alive += !eliminated[i];
+  free(means);
+  return alive;
+}
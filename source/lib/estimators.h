@@ -0,0 +1,29 @@
+#include "estimators.c"
+
+void init_mser(mser_state*, long);
+void mser_update(mser_state*, double);
+int mser_stable(mser_state*);
+void free_mser(mser_state*);
+double lag1_autocorrelation(double*, long);
+int batches_uncorrelated(analysis**, long);
+void init_interval_stream(interval_stream*, long, double);
+void grow_interval_stream(interval_stream*, long);
+void record_interval(interval_stream*, node_stats*, time_integrated*, double);
+void reset_interval_snapshot(interval_stream*);
+void free_interval_stream(interval_stream*);
+double spectral_weight(variance_estimator, long, long);
+void estimate_variance(double*, long, long, long, double[VARIANCE_ESTIMATORS][2]);
+void extract_variance_analysis(interval_stream*, variance_analysis*, long);
+void ratio_estimate(double*, double*, long, double*);
+void extract_regenerative_analysis(interval_stream*, statistic_analysis*, int*);
+int solve_linear_system(double*, double*, int);
+void control_variate_estimate(double*, double*, long, int, double*);
+void extract_control_variate_analysis(analysis**, long, double*, double*, control_variate_analysis*);
+void welford_update(double*, long, double);
+void extract_gradient_analysis(gradient_sample*, long, gradient_analysis*);
+void record_plain_cycle(rare_event_analysis*, long, long, long);
+void record_tilted_excursion(rare_event_analysis*, long, double);
+void extract_rare_event_analysis(rare_event_analysis*);
+double kn_parameter(int, long, double);
+void kn_variances(double*, long, int, long, double*);
+int kn_screen(double*, long, int, long, double*, double, double, long*);
@@ -0,0 +1,92 @@
+/**
+* Allocate an array of the mesh
+**/
+void *mesh_alloc(mesh_network *mesh, long count, size_t size){
+  void *array = calloc(count > 0 ? count : 1, size);
+
+  if(array == NULL){
+    printf("Error allocating memory: mesh of %d nodes\n", mesh->nodes);
+    exit(5);
+  }
+  return array;
+}
+
+/**
+* Generate a random feed-forward mesh in the parameter layout of the engine: every node routes only to nodes with a higher
+* index, so all the jobs leave it. The servers of every node are sized on the traffic equations for the same utilization
+**/
+void generate_mesh(mesh_network *mesh, int size, int classes){
+  double *rate, weight[MESH_MAX_FANOUT], tot_weight;
+  int chosen[MESH_MAX_FANOUT], fanout, pick;
+  route_table *route;
+
+  memset(mesh, 0, sizeof(mesh_network));
+  mesh->nodes = size;
+  mesh->classes = classes;
+  mesh->entries = (int) ceil(size * MESH_ENTRY_SHARE);
+  mesh->lambda = mesh_alloc(mesh, size, sizeof(double));
+  mesh->mu = mesh_alloc(mesh, size, sizeof(double));
+  mesh->servers = mesh_alloc(mesh, size, sizeof(int));
+  mesh->queue = mesh_alloc(mesh, size, sizeof(unsigned long));
+  mesh->routes = mesh_alloc(mesh, size, sizeof(route_table));
+  mesh->class_prob = mesh_alloc(mesh, classes, sizeof(double));
+  rate = mesh_alloc(mesh, size, sizeof(double));
+
+  SelectStream(MESH_STREAM);
+  for(int i=0; i<size; i++){
+    mesh->mu[i] = Uniform(0.5, 2.0);
+    mesh->lambda[i] = i < mesh->entries ? MESH_EXTERNAL_RATE / mesh->entries : 0.0;
+    mesh->queue[i] = Random() < MESH_FINITE_SHARE ? MESH_QUEUE : INFINITE_CAPACITY;
+
+    // distinct destinations among the following nodes (Floyd's sampling) with random weights, the rest leaves the mesh
+    fanout = (int) Equilikely(1, MESH_MAX_FANOUT);
+    if(fanout > size - 1 - i) fanout = size - 1 - i;
+    tot_weight = 0;
+    for(int d=0, j=size-1-i-fanout; d<fanout; d++, j++){
+      pick = (int) Equilikely(0, j);
+      for(int k=0; k<d; k++){
+        if(chosen[k] == pick){
+          pick = j;
+          break;
+        }
+      }
+      chosen[d] = pick;
+      weight[d] = Uniform(0.1, 1.0);
+      tot_weight += weight[d];
+    }
+    route = &mesh->routes[i];
+    for(int d=0; d<fanout; d++) add_route(route, i + 1 + chosen[d], weight[d] * (1 - MESH_EXIT_PROB) / tot_weight);
+    close_route(route);
+    mesh->edges += route->fanout;
+  }
+
+  // traffic equations: the nodes are already in topological order
+  for(int i=0; i<size; i++){
+    rate[i] += mesh->lambda[i];
+    route = &mesh->routes[i];
+    for(int d=0; d<route->fanout; d++){
+      if(route->destination[d] != outside) rate[route->destination[d]] += rate[i] * route->prob[d];
+    }
+    mesh->servers[i] = (int) ceil(rate[i] / (mesh->mu[i] * MESH_UTILIZATION));
+    if(mesh->servers[i] < 1) mesh->servers[i] = 1;
+    if(rate[i] > rate[mesh->busiest]) mesh->busiest = i;
+  }
+  free(rate);
+
+  // the lower classes are the more frequent and have the higher priority
+  tot_weight = 0;
+  for(int k=0; k<classes; k++) tot_weight += classes - k;
+  for(int k=0; k<classes; k++) mesh->class_prob[k] = (classes - k) / tot_weight;
+}
+
+/**
+* Release all the memory of the mesh
+**/
+void free_mesh(mesh_network *mesh){
+  free(mesh->lambda);
+  free(mesh->mu);
+  free(mesh->servers);
+  free(mesh->queue);
+  free(mesh->routes);
+  free(mesh->class_prob);
+}
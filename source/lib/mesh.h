@@ -0,0 +1,5 @@
+#include "mesh.c"
+
+void *mesh_alloc(mesh_network*, long, size_t);
+void generate_mesh(mesh_network*, int, int);
+void free_mesh(mesh_network*);
@@ -0,0 +1,225 @@
+char node_names[NODES][MODEL_MAX_NAME] = {"flight", "hotel", "taxi", "payment_control"};
+
+/**
+* Stop on a malformed line of the model file
+**/
+void model_error(char *filename, int line, char *message){
+  printf("Error in the model file %s at line %d: %s\n", filename, line, message);
+  exit(0);
+}
+
+/**
+* Remove the leading and trailing blanks of a string
+**/
+char *trim_blanks(char *s){
+  char *end;
+
+  while(*s == ' ' || *s == '\t') s++;
+  end = s + strlen(s);
+  while(end > s && (end[-1] == ' ' || end[-1] == '\t')) end--;
+  *end = '\0';
+  return s;
+}
+
+/**
+* Index of a node given its name, -1 if unknown
+**/
+int model_node(char *name){
+  for(int i=0; i<NODES; i++){
+    if(*node_names[i] != '\0' && strcmp(name, node_names[i]) == 0) return i;
+  }
+  return -1;
+}
+
+/**
+* Index of a node of the model file: a new name adds a node after the others, with an infinite queue and no external arrivals
+**/
+int model_section(topology_model *model, char *name, char *filename, int line){
+  int node = model_node(name);
+
+  if(node >= 0) return node;
+  if(*name == '\0' || strlen(name) >= MODEL_MAX_NAME) model_error(filename, line, "node names must have 1 to MODEL_MAX_NAME - 1 characters");
+  if(model->nodes >= NODES) model_error(filename, line, "too many nodes (NODES)");
+  node = model->nodes++;
+  strcpy(node_names[node], name);
+  model->lambda[node] = 0;
+  model->mu[node] = 0;
+  model->servers[node] = 0;
+  model->queue[node] = INFINITE_CAPACITY;
+  return node;
+}
+
+/**
+* Parse a number of the model file, the whole value must be consumed
+**/
+double model_number(char *value, char *filename, int line){
+  char *end;
+  double number = strtod(value, &end);
+
+  if(end == value || *trim_blanks(end) != '\0') model_error(filename, line, "expected a number");
+  return number;
+}
+
+/**
+* Parse the routing of a node: destinations with their probability (e.g. payment_control:0.65, taxi:0.15), the rest leaves the system
+**/
+void model_routes(topology_model *model, route_table *route, char *value, char *filename, int line){
+  char *token, *separator;
+  int destination;
+  double prob;
+
+  memset(route, 0, sizeof(route_table));
+  for(token = strtok(value, ", \t"); token != NULL; token = strtok(NULL, ", \t")){
+    separator = strchr(token, ':');
+    if(separator == NULL) model_error(filename, line, "expected node:probability");
+    *separator = '\0';
+    destination = model_section(model, token, filename, line);
+    prob = model_number(separator + 1, filename, line);
+    if(prob < 0 || prob > 1) model_error(filename, line, "routing probabilities must be between 0 and 1");
+    if(route->fanout >= NODES) model_error(filename, line, "too many destinations");
+    add_route(route, destination, prob);
+  }
+  if(route->fanout > 0 && route->threshold[route->fanout - 1] > 1 + MODEL_TOLERANCE) model_error(filename, line, "routing probabilities sum to more than 1");
+  close_route(route);
+}
+
+/**
+* Parse the daily rate profile of a node: hours of the day with the rate from then on (e.g. 0:0.5, 8:2.4, 20:1.2)
+**/
+void model_rates(arrival_rates *rates, char *value, char *filename, int line){
+  char *token, *separator;
+  double hour;
+  int linear = rates->linear;
+
+  memset(rates, 0, sizeof(arrival_rates));
+  rates->linear = linear;
+  for(token = strtok(value, ", \t"); token != NULL; token = strtok(NULL, ", \t")){
+    separator = strchr(token, ':');
+    if(separator == NULL) model_error(filename, line, "expected hour:rate");
+    *separator = '\0';
+    hour = model_number(token, filename, line);
+    if(rates->points == 0 && hour != 0) model_error(filename, line, "the first rate must start at hour 0");
+    if(rates->points > 0 && hour * RATE_HOUR <= rates->time[rates->points - 1]) model_error(filename, line, "the hours must be increasing");
+    if(hour * RATE_HOUR >= RATE_PERIOD) model_error(filename, line, "the hours must be within the day");
+    if(rates->points >= RATE_MAX_POINTS) model_error(filename, line, "too many rates (RATE_MAX_POINTS)");
+    rates->time[rates->points] = hour * RATE_HOUR;
+    rates->rate[rates->points] = model_number(separator + 1, filename, line);
+    if(rates->rate[rates->points] < 0) model_error(filename, line, "rates can't be negative");
+    rates->points++;
+  }
+  if(rates->points == 0) model_error(filename, line, "expected hour:rate");
+}
+
+/**
+* Check if the jobs leaving a node can reach the target node (depth-first visit of the routing)
+**/
+int model_reaches(topology_model *model, int from, int target, int depth){
+  int destination;
+
+  if(depth > NODES) return 0;                 // a cycle not through the target, found when its own nodes are checked
+  for(int d=0; d<model->routes[from].fanout; d++){
+    destination = model->routes[from].destination[d];
+    if(destination == outside || model->routes[from].prob[d] == 0) continue;
+    if(destination == target || model_reaches(model, destination, target, depth + 1)) return 1;
+  }
+  return 0;
+}
+
+/**
+* Read a model file over the compiled parameters of a topology.
+* Every [node] section may set servers, mu, lambda, queue (a number or infinite), routing and a daily profile of the
+* external arrivals (rates and shape), which replaces lambda with its daily mean. A section (or a destination) with a new
+* name adds a node, which needs at least servers and mu
+**/
+void load_model(topology_model *model, char *filename){
+  FILE *file = fopen(filename, "r");
+  char line[MODEL_MAX_LINE], *key, *value, *separator;
+  int node = -1, line_num = 0;
+  double number, total_lambda = 0;
+
+  if(file == NULL){
+    printf("Error opening the model file: %s\n", filename);
+    exit(0);
+  }
+  while(fgets(line, sizeof(line), file) != NULL){
+    line_num++;
+    line[strcspn(line, ";#\r\n")] = '\0';     // comments start with ';' or '#'
+    key = trim_blanks(line);
+    if(*key == '\0') continue;
+
+    if(*key == '['){
+      separator = strchr(key, ']');
+      if(separator == NULL) model_error(filename, line_num, "unterminated section");
+      *separator = '\0';
+      node = model_section(model, trim_blanks(key + 1), filename, line_num);
+      continue;
+    }
+
+    separator = strchr(key, '=');
+    if(separator == NULL || node < 0) model_error(filename, line_num, "expected key = value inside a node section");
+    *separator = '\0';
+    value = trim_blanks(separator + 1);
+    key = trim_blanks(key);
+    if(strcmp(key, "servers") == 0){
+      number = model_number(value, filename, line_num);
+      if(number < 1 || number > OPTIMIZER_MAX_SERVERS || number != (int)number) model_error(filename, line_num, "servers must be an integer between 1 and OPTIMIZER_MAX_SERVERS");
+      model->servers[node] = number;
+    }
+    else if(strcmp(key, "mu") == 0){
+      model->mu[node] = model_number(value, filename, line_num);
+      if(model->mu[node] <= 0) model_error(filename, line_num, "mu must be positive");
+    }
+    else if(strcmp(key, "lambda") == 0){
+      model->lambda[node] = model_number(value, filename, line_num);
+      if(model->lambda[node] < 0) model_error(filename, line_num, "lambda can't be negative");
+    }
+    else if(strcmp(key, "queue") == 0){
+      if(strcmp(value, "infinite") == 0) model->queue[node] = INFINITE_CAPACITY;
+      else{
+        number = model_number(value, filename, line_num);
+        if(number < 0 || number >= INFINITE_CAPACITY || number != (long)number) model_error(filename, line_num, "queue must be a non negative integer or infinite");
+        model->queue[node] = number;
+      }
+    }
+    else if(strcmp(key, "routing") == 0){
+      model_routes(model, &model->routes[node], value, filename, line_num);
+    }
+    else if(strcmp(key, "rates") == 0){
+      model_rates(&model->rates[node], value, filename, line_num);
+    }
+    else if(strcmp(key, "shape") == 0){
+      if(strcmp(value, "step") == 0) model->rates[node].linear = 0;
+      else if(strcmp(value, "linear") == 0) model->rates[node].linear = 1;
+      else model_error(filename, line_num, "shape must be step or linear");
+    }
+    else model_error(filename, line_num, "unknown key (servers, mu, lambda, queue, routing, rates, shape)");
+  }
+  fclose(file);
+
+  for(int i=0; i<model->nodes; i++){
+    if(model->servers[i] < 1 || model->mu[i] <= 0){
+      printf("Error in the model file %s: the node %s needs servers and mu\n", filename, node_names[i]);
+      exit(0);
+    }
+    if(model->rates[i].points == 0) continue;
+    close_arrival_rates(&model->rates[i]);
+    model->lambda[i] = mean_arrival_rate(&model->rates[i]);
+    if(model->lambda[i] <= 0){
+      printf("Error in the model file %s: the rates of %s are always 0\n", filename, node_names[i]);
+      exit(0);
+    }
+  }
+
+  // the jobs must leave the system: the traffic equations and the replay of payment_control assume a feed-forward network
+  for(int i=0; i<model->nodes; i++){
+    if(model_reaches(model, i, i, 0)){
+      printf("Error in the model file %s: the routing of %s has a cycle\n", filename, node_names[i]);
+      exit(0);
+    }
+    total_lambda += model->lambda[i];
+  }
+  if(total_lambda <= 0){
+    printf("Error in the model file %s: at least one node needs external arrivals\n", filename);
+    exit(0);
+  }
+}
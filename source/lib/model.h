@@ -0,0 +1,11 @@
+#include "model.c"
+
+void model_error(char*, int, char*);
+char *trim_blanks(char*);
+int model_node(char*);
+int model_section(topology_model*, char*, char*, int);
+double model_number(char*, char*, int);
+void model_routes(topology_model*, route_table*, char*, char*, int);
+void model_rates(arrival_rates*, char*, char*, int);
+int model_reaches(topology_model*, int, int, int);
+void load_model(topology_model*, char*);
@@ -1,93 +1,279 @@
+int nodes_num = COMPILED_NODES;          // nodes of the simulated network, a model file can add more up to NODES
+int classes_num = PRIORITY_CLASSES;      // priority classes of the priority node, a benchmark mesh sets its own
+
 /**
-* Find the next node where to send a job
+* Draw a uniform from the selected stream, complemented (1 - U) in the antithetic replica of a pair
+**/
+double AntitheticRandom(int antithetic){
+  double u = Random();
+  return antithetic ? 1.0 - u : u;
+}
+
+/**
+* Stream of the arrivals or of the services of a node: every 20th stream for the compiled nodes, the ones halfway for
+* the nodes added by a model file. The nodes of a benchmark mesh beyond NODES share the streams of the added nodes
+**/
+int node_stream(node_id node, int service){
+  if(node < COMPILED_NODES) return 20*(service*COMPILED_NODES + node);
+  if(node >= NODES) node = COMPILED_NODES + (node - COMPILED_NODES) % (NODES - COMPILED_NODES);
+  return 20*(service*COMPILED_NODES + node - COMPILED_NODES) + 10;
+}
+
+/**
+* Save the state of all the streams
+**/
+void save_streams(long *state){
+  for(int i=0; i<RNG_STREAMS; i++){
+    SelectStream(i);
+    GetSeed(&state[i]);
+  }
+}
+
+/**
+* Restore the state of all the streams
+**/
+void restore_streams(long *state){
+  for(int i=0; i<RNG_STREAMS; i++){
+    SelectStream(i);
+    PutSeed(state[i]);
+  }
+}
+
+/**
+* Build the alias table of n outcomes with Vose's method: every column i holds cut[i] of outcome i and the rest of alias[i]
+**/
+void build_alias(double *prob, int n, double *cut, int *alias){
+  int *small = calloc(n, sizeof(int));
+  int *large = calloc(n, sizeof(int));
+  int small_n = 0, large_n = 0, s, l;
+  double total = 0;
+
+  if(small == NULL || large == NULL){
+    printf("Error allocating memory: alias table\n");
+    exit(5);
+  }
+  for(int i=0; i<n; i++) total += prob[i];
+  for(int i=0; i<n; i++){
+    cut[i] = prob[i] * n / total;
+    alias[i] = i;
+    if(cut[i] < 1) small[small_n++] = i;
+    else large[large_n++] = i;
+  }
+  while(small_n > 0 && large_n > 0){
+    s = small[--small_n];
+    l = large[--large_n];
+    alias[s] = l;
+    cut[l] -= 1 - cut[s];
+    if(cut[l] < 1) small[small_n++] = l;
+    else large[large_n++] = l;
+  }
+  // the columns left are full up to rounding errors
+  while(large_n > 0) cut[large[--large_n]] = 1;
+  while(small_n > 0) cut[small[--small_n]] = 1;
+
+  free(small);
+  free(large);
+}
+
+/**
+* Draw an outcome from an alias table with a single uniform: the integer part selects the column, the fraction the side of the cut
+**/
+int alias_sample(double *cut, int *alias, int n, double rand){
+  double x = rand * n;
+  int i = (int) x;
+
+  if(i >= n) i = n - 1;
+  return x - i < cut[i] ? i : alias[i];
+}
+
+/**
+* Find the next node where to send a job given the uniform of the routing decision
 **/
-node_id SwitchNode(double *prob, node_id start_node){
-  node_id destination_node;
-  double rand;
+node_id RouteNode(route_table *routes, node_id start_node, double rand){
+  route_table *route = &routes[start_node];
+  int i = 0;
 
+  // wide fan-out: O(1) with the alias table
+  if(route->fanout >= ALIAS_MIN_OUTCOMES) return route->destination[alias_sample(route->cut, route->alias, route->fanout, rand)];
+
+  // the first cumulative threshold above the uniform selects the destination, the last one takes the rest
+  while(i < route->fanout - 1 && rand >= route->threshold[i]) i++;
+  return route->destination[i];
+}
+
+/**
+* Find the next node where to send a job
+**/
+node_id SwitchNode(route_table *routes, node_id start_node, int antithetic){
   SelectStream(192);
-  rand = Random();
+  return RouteNode(routes, start_node, AntitheticRandom(antithetic));
+}
 
-  switch(start_node){
-    case flight:
-      if(rand < prob[0]) destination_node = payment_control;
-      else if(rand > 1 - prob[1]) destination_node = hotel;
-      else destination_node = taxi;
-      break;
+/**
+* Append a destination to the routing table of a node
+**/
+void add_route(route_table *route, node_id destination, double prob){
+  double previous = route->fanout > 0 ? route->threshold[route->fanout - 1] : 0;
 
-    case hotel:
-      if(rand < prob[2]) destination_node = taxi;           
-      else destination_node = payment_control;
-      break;
-    
-    case taxi:
-      destination_node = payment_control;
-      break;
+  route->destination[route->fanout] = destination;
+  route->prob[route->fanout] = prob;
+  route->threshold[route->fanout] = previous + prob;
+  route->fanout++;
+}
 
-    default:
-      destination_node = outside;
-      break;
+/**
+* Complete the routing table of a node: the probability left by the destinations leaves the system
+**/
+void close_route(route_table *route){
+  double previous = route->fanout > 0 ? route->threshold[route->fanout - 1] : 0;
+
+  if(route->fanout == 0 || 1 - previous > MODEL_TOLERANCE) add_route(route, outside, 1 - previous);
+  build_alias(route->prob, route->fanout, route->cut, route->alias);
+}
+
+/**
+* Routing tables of the reservation app: flight -> payment_control, taxi or hotel, hotel -> taxi or payment_control, taxi -> payment_control
+**/
+void default_routes(double *prob, route_table *routes){
+  memset(routes, 0, NODES * sizeof(route_table));
+  add_route(&routes[flight], payment_control, prob[0]);
+  add_route(&routes[flight], taxi, 1 - prob[0] - prob[1]);
+  add_route(&routes[flight], hotel, prob[1]);
+  add_route(&routes[hotel], taxi, prob[2]);
+  add_route(&routes[hotel], payment_control, 1 - prob[2]);
+  add_route(&routes[taxi], payment_control, 1);
+  for(int i=0; i<NODES; i++) close_route(&routes[i]);
+}
+
+/**
+* Routing probabilities between the nodes, the same decisions taken by RouteNode
+**/
+void routing_matrix(route_table *routes, double routing[NODES][NODES]){
+  memset(routing, 0, NODES * NODES * sizeof(double));
+  for(int i=0; i<NODES; i++){
+    for(int d=0; d<routes[i].fanout; d++){
+      if(routes[i].destination[d] != outside) routing[i][routes[i].destination[d]] += routes[i].prob[d];
+    }
   }
+}
 
-  return destination_node;
+/**
+* Solve the traffic equations rate = external + routing' * rate (the network is acyclic, NODES sweeps are enough)
+**/
+void traffic_equations(double *external, route_table *routes, double *rate){
+  double routing[NODES][NODES];
+
+  routing_matrix(routes, routing);
+  for(int i=0; i<NODES; i++) rate[i] = external[i];
+  for(int sweep=0; sweep<NODES; sweep++){
+    for(int j=0; j<NODES; j++){
+      rate[j] = external[j];
+      for(int i=0; i<NODES; i++) rate[j] += rate[i] * routing[i][j];
+    }
+  }
 }
 
 /**
-* Find the priority queue responsible for handling a job
+* Check the probabilities of the priority classes and build the table used to select them
 **/
-int SelectPriorityClass(int classes_num, double *probs)
-{
+void init_priority_table(priority_table *table, int classes, double *probs){
   double tot_prob = 0;
-  double aux = 0;
-  for(int i=0; i<classes_num; i++){
+
+  table->threshold = calloc(classes, sizeof(double));
+  table->cut = calloc(classes, sizeof(double));
+  table->alias = calloc(classes, sizeof(int));
+  if(table->threshold == NULL || table->cut == NULL || table->alias == NULL){
+    printf("Error allocating memory: priority table\n");
+    exit(5);
+  }
+  for(int i=0; i<classes; i++){
     if(probs[i]<0 || probs[i]>1){
       printf("Parameter 'p' of class %d must be between 0 and 1\n", i);
       exit(0);
     }
     tot_prob += probs[i];
+    table->threshold[i] = tot_prob;
   }
-  if(tot_prob != 1){
+  if(fabs(tot_prob - 1) > MODEL_TOLERANCE){
     printf("Sum of parameters 'p' must be equal to 1\n");
     exit(0);
   }
+  table->classes = classes;
+  build_alias(probs, classes, table->cut, table->alias);
+}
 
-  SelectStream(140);
+/**
+* Free the arrays of a priority table
+**/
+void free_priority_table(priority_table *table){
+  free(table->threshold);
+  free(table->cut);
+  free(table->alias);
+}
 
-  double ext = Random();
-  for(int i=0; i<classes_num; i++){
-    aux += probs[i];
-    if(ext <= aux) return i;
+/**
+* Find the priority class given the uniform of the class selection: the PRIORITY_CLASSES classes of the improved
+* topology scan the thresholds, a benchmark mesh with ALIAS_MIN_OUTCOMES classes or more (--classes) uses the alias table
+**/
+int ClassifyPriority(priority_table *table, double ext){
+  if(table->classes >= ALIAS_MIN_OUTCOMES) return alias_sample(table->cut, table->alias, table->classes, ext);
+  for(int i=0; i<table->classes; i++){
+    if(ext <= table->threshold[i]) return i;
   }
-  return classes_num-1;
+  return table->classes-1;
 }
 
 /**
-* Find the first available (idle) server to serve a job
-**/ 
-int SelectServer(node_stats node){ 
-  int i=0, s;
-  while(node.servers[i].status == busy) i++;
-  
-  if(i >= node.total_servers){
+* Find the priority queue responsible for handling a job
+**/
+int SelectPriorityClass(priority_table *table, int antithetic)
+{
+  SelectStream(140);
+  return ClassifyPriority(table, AntitheticRandom(antithetic));
+}
+
+/**
+* Put all the servers of a node in the idle FIFO, in index order
+**/
+void init_idle_servers(node_stats *node){
+  for(int s=0; s<node->total_servers; s++) node->servers[s].next_idle = s + 1 < node->total_servers ? s + 1 : -1;
+  node->idle_head = node->total_servers > 0 ? 0 : -1;
+  node->idle_tail = node->total_servers - 1;
+}
+
+/**
+* Take the longest idle server to serve a job: servers become idle in order of time, so it's the head of the idle FIFO
+**/
+int SelectServer(node_stats *node){
+  int s = node->idle_head;
+
+  if(s < 0){
     printf("Error: You are trying to serve a job when all servers are busy!!\n\n");
     exit(0);
   }
-
-  s = i;
-  for(i=s+1; i<node.total_servers; i++){
-    if(node.servers[i].status == idle && node.servers[i].last_departure_time < node.servers[s].last_departure_time) s = i;
-  }
+  node->idle_head = node->servers[s].next_idle;
+  if(node->idle_head < 0) node->idle_tail = -1;
 
   return s;
 }
 
+/**
+* Append a server that has just become idle to the idle FIFO of the node
+**/
+void ReleaseServer(node_stats *node, int s){
+  node->servers[s].next_idle = -1;
+  if(node->idle_tail < 0) node->idle_head = s;
+  else node->servers[node->idle_tail].next_idle = s;
+  node->idle_tail = s;
+}
+
 /**
 * Generate a new event
 **/
 event* GenerateEvent(event_type type, node_id node, int server, double time){
   event* new_event;
 
-  if(node >= NODES) return NULL;
+  if(node == outside) return NULL;
 
   new_event = malloc(sizeof(event));
   if(new_event == NULL){
@@ -149,22 +335,134 @@ event* ExtractEvent(event **list){
 }
 
 /**
-* Generate a new job
+* Remove from the event list the event of a specific type, node and server
+**/
+event* RemoveEvent(event **list, event_type type, node_id node, int server){
+  event *prev = NULL, *tmp = *list;
+
+  while(tmp != NULL && (tmp->type != type || tmp->node != node || tmp->server != server)){
+    prev = tmp;
+    tmp = tmp->next;
+  }
+  if(tmp == NULL){
+    printf("Error: event not found in the event list\n");
+    exit(0);
+  }
+  if(prev == NULL) *list = tmp->next;
+  else prev->next = tmp->next;
+
+  return tmp;
+}
+
+int job_derivatives = 0;                // IPA components stored after every job, 0 without --gradient
+
+/**
+* Generate a new job, with room for its IPA derivatives only when they are estimated
 **/
 job* GenerateJob(double arrival, double service, int priority){
-  job* new_job = malloc(sizeof(job));
+  job* new_job = malloc(sizeof(job) + job_derivatives * sizeof(double));
   if(new_job == NULL){
     printf("Error allocating memory for a job\n");
     exit(1);
   }
+  new_job->derivative = job_derivatives > 0 ? (double*)(new_job + 1) : NULL;
   new_job->arrival = arrival;
   new_job->service = service;
   new_job->priority = priority;
+  new_job->profile = NULL;
   new_job->next = NULL;
 
   return new_job;
 }
 
+/**
+* Generate a new external job drawing all its random numbers (services, routing, priority) at once,
+* so that the same job sees the same values in every compared topology
+**/
+job* GenerateProfileJob(double arrival, node_id entry, double *mu, priority_table *classes){
+  job* new_job = GenerateJob(arrival, 0, 0);
+  new_job->profile = malloc(sizeof(job_profile));
+  if(new_job->profile == NULL){
+    printf("Error allocating memory for a job profile\n");
+    exit(1);
+  }
+
+  SelectStream(PROFILE_STREAM + 20*entry);
+  for(int i=0; i<nodes_num; i++){
+    new_job->profile->service[i] = Exponential(1.0/mu[i]);
+    new_job->profile->route[i] = Random();
+  }
+  new_job->profile->priority = ClassifyPriority(classes, Random());
+  new_job->priority = new_job->profile->priority;
+
+  return new_job;
+}
+
+/**
+* Generate a job of a replayed request: the service demands given by the log (>= 0) replace the ones drawn from mu
+**/
+job* GenerateLogJob(double arrival, node_id entry, double *mu, priority_table *classes, double *service){
+  job* new_job = GenerateProfileJob(arrival, entry, mu, classes);
+
+  for(int i=0; service != NULL && i<nodes_num; i++){
+    if(service[i] >= 0) new_job->profile->service[i] = service[i];
+  }
+
+  return new_job;
+}
+
+/**
+* Copy a profiled job, every configuration fed by the same input stream gets its own copy
+**/
+job* CopyProfileJob(job *source){
+  job* new_job = GenerateJob(source->arrival, source->service, source->priority);
+  new_job->profile = malloc(sizeof(job_profile));
+  if(new_job->profile == NULL){
+    printf("Error allocating memory for a job profile\n");
+    exit(1);
+  }
+
+  *new_job->profile = *source->profile;
+
+  return new_job;
+}
+
+/**
+* Generate a profiled job arriving at payment_control from a recorded trace
+**/
+job* GenerateTraceJob(trace_arrival *arrival){
+  job* new_job = GenerateJob(arrival->time, 0, arrival->priority);
+  new_job->profile = calloc(1, sizeof(job_profile));
+  if(new_job->profile == NULL){
+    printf("Error allocating memory for a job profile\n");
+    exit(1);
+  }
+
+  new_job->profile->service[payment_control] = arrival->service;
+  new_job->profile->priority = arrival->priority;
+
+  return new_job;
+}
+
+/**
+* Prepare a profiled job for the service at the next node
+**/
+job* RouteJob(job *routed_job, double arrival, node_id node){
+  routed_job->arrival = arrival;
+  routed_job->service = routed_job->profile->service[node];
+  routed_job->next = NULL;
+
+  return routed_job;
+}
+
+/**
+* Free a job and its profile
+**/
+void FreeJob(job *old_job){
+  free(old_job->profile);
+  free(old_job);
+}
+
 /**
 * Insert a job in a node's queue
 **/
@@ -219,13 +517,14 @@ job* ExtractJob(job **queue)
 * Reset integrals to clean values for next batch in infinite horizon simulation
 **/
 void reset_stats(node_stats *nodes, time_integrated *areas, double *first_arrival){
-  for(int i=0; i<NODES; i++){
+  for(int i=0; i<nodes_num; i++){
     first_arrival[i] = nodes[i].last_arrival;
     nodes[i].processed_jobs = 0;
     nodes[i].rejected_jobs = 0;
+    if(nodes[i].wait_derivative != NULL) memset(nodes[i].wait_derivative, 0, IPA_PARAMETERS * sizeof(double));
     for(int s=0; s<nodes[i].total_servers; s++){
-      nodes[i].servers[s].service_time = 0;
-      nodes[i].servers[s].served_jobs = 0;
+      nodes[i].totals[s].service_time = 0;
+      nodes[i].totals[s].served_jobs = 0;
     }
     areas[i].node_area = 0;
     areas[i].queue_area = 0;
@@ -236,30 +535,59 @@ void reset_stats(node_stats *nodes, time_integrated *areas, double *first_arriva
 * Reset integrals to clean values for next batch in infinite horizon simulation
 **/
 void reset_priority_stats(node_stats *nodes, time_integrated *areas){
-  for(int i=0; i<PRIORITY_CLASSES; i++){
+  for(int i=0; i<classes_num; i++){
     nodes[i].processed_jobs = 0;
     nodes[i].rejected_jobs = 0;
     for(int s=0; s<nodes[i].total_servers; s++){
-      nodes[i].servers[s].service_time = 0;
-      nodes[i].servers[s].served_jobs = 0;
+      nodes[i].totals[s].service_time = 0;
+      nodes[i].totals[s].served_jobs = 0;
     }
     areas[i].node_area = 0;
     areas[i].queue_area = 0;
   }
 }
 
+/**
+* Empty n nodes to start the simulation again on the same servers: the jobs are freed and every counter is zeroed
+**/
+void clear_nodes(node_stats *nodes, time_integrated *areas, int n){
+  job *queued;
+
+  for(int i=0; i<n; i++){
+    for(int s=0; s<nodes[i].total_servers; s++){
+      if(nodes[i].servers[s].status == busy && nodes[i].servers[s].serving_job != NULL) FreeJob(nodes[i].servers[s].serving_job);
+      nodes[i].servers[s].status = idle;
+      nodes[i].servers[s].serving_job = NULL;
+      nodes[i].servers[s].last_departure_time = 0;
+      nodes[i].totals[s].service_time = 0;
+      nodes[i].totals[s].served_jobs = 0;
+    }
+    while((queued = ExtractJob(&nodes[i].queue)) != NULL) FreeJob(queued);
+    nodes[i].queue_jobs = 0;
+    nodes[i].service_jobs = 0;
+    nodes[i].node_jobs = 0;
+    nodes[i].rejected_jobs = 0;
+    nodes[i].processed_jobs = 0;
+    nodes[i].last_arrival = 0;
+    if(nodes[i].wait_derivative != NULL) memset(nodes[i].wait_derivative, 0, IPA_PARAMETERS * sizeof(double));
+    init_idle_servers(&nodes[i]);
+    areas[i].node_area = 0;
+    areas[i].queue_area = 0;
+  }
+}
+
 /**
 * Extract intermediate results from a single run (finite horizon) or a single batch (infinite horizon) of the base/resized simulation
 **/
 void extract_analysis(analysis *result, node_stats *nodes, time_integrated *areas, int *servers_num, double oper_period, double *first_arrival){
   double total_service[NODES];
 
-  for(int k=0; k<NODES; k++){
+  for(int k=0; k<nodes_num; k++){
     total_service[k] = 0;
-    for(int s=0; s<servers_num[k]; s++) total_service[k] += nodes[k].servers[s].service_time;
+    for(int s=0; s<servers_num[k]; s++) total_service[k] += nodes[k].totals[s].service_time;
   }
 
-  for(int i=0; i<NODES; i++){
+  for(int i=0; i<nodes_num; i++){
     result[i].jobs = nodes[i].processed_jobs;
 
     if(first_arrival == NULL) result[i].interarrival = (nodes[i].last_arrival - START) / nodes[i].processed_jobs;
@@ -281,9 +609,9 @@ void extract_analysis(analysis *result, node_stats *nodes, time_integrated *area
     else result[i].ploss = (double) nodes[i].rejected_jobs / (nodes[i].rejected_jobs + nodes[i].processed_jobs);
 
     for(int s=0; s<servers_num[i]; s++){
-      result[i].server_utilization[s] = nodes[i].servers[s].service_time / oper_period;
-      result[i].server_service[s] = nodes[i].servers[s].service_time / nodes[i].servers[s].served_jobs;
-      result[i].server_share[s] = (double) nodes[i].servers[s].served_jobs * 100 / nodes[i].processed_jobs;
+      result[i].server_utilization[s] = nodes[i].totals[s].service_time / oper_period;
+      result[i].server_service[s] = nodes[i].totals[s].service_time / nodes[i].totals[s].served_jobs;
+      result[i].server_share[s] = (double) nodes[i].totals[s].served_jobs * 100 / nodes[i].processed_jobs;
     }
   }
 }
@@ -296,7 +624,7 @@ void extract_priority_analysis(analysis *result, node_stats *nodes, time_integra
 
   for(int k=0; k<PRIORITY_CLASSES; k++){
     total_service[k] = 0;
-    for(int s=0; s<servers_num; s++) total_service[k] += nodes[k].servers[s].service_time;
+    for(int s=0; s<servers_num; s++) total_service[k] += nodes[k].totals[s].service_time;
   }
 
   for(int i=0; i<PRIORITY_CLASSES; i++){
@@ -321,20 +649,74 @@ void extract_priority_analysis(analysis *result, node_stats *nodes, time_integra
     else result[i].ploss = (double) nodes[i].rejected_jobs / (nodes[i].rejected_jobs + nodes[i].processed_jobs);
 
     for(int s=0; s<servers_num; s++){
-      result[i].server_utilization[s] = nodes[i].servers[s].service_time / oper_period;
-      result[i].server_service[s] = nodes[i].servers[s].service_time / nodes[i].servers[s].served_jobs;
-      result[i].server_share[s] = (double) nodes[i].servers[s].served_jobs * 100 / nodes[i].processed_jobs;
+      result[i].server_utilization[s] = nodes[i].totals[s].service_time / oper_period;
+      result[i].server_service[s] = nodes[i].totals[s].service_time / nodes[i].totals[s].served_jobs;
+      result[i].server_share[s] = (double) nodes[i].totals[s].served_jobs * 100 / nodes[i].processed_jobs;
     }
   }
 }
 
+/**
+* Merge the analysis of two consecutive batches of the same size into a single batch of double size
+**/
+void merge_analysis(analysis *result, analysis *first, analysis *second, int servers_num){
+  result->jobs = first->jobs + second->jobs;
+  result->interarrival = (first->interarrival + second->interarrival) / 2;
+  result->wait = (first->wait + second->wait) / 2;
+  result->delay = (first->delay + second->delay) / 2;
+  result->service = (first->service + second->service) / 2;
+  result->Ns = (first->Ns + second->Ns) / 2;
+  result->Nq = (first->Nq + second->Nq) / 2;
+  result->utilization = (first->utilization + second->utilization) / 2;
+  result->ploss = (first->ploss + second->ploss) / 2;
+  for(int s=0; s<servers_num; s++){
+    result->server_utilization[s] = (first->server_utilization[s] + second->server_utilization[s]) / 2;
+    result->server_service[s] = (first->server_service[s] + second->server_service[s]) / 2;
+    result->server_share[s] = (first->server_share[s] + second->server_share[s]) / 2;
+  }
+}
+
+/**
+* Compute the per-replica (per-batch) differences of two topologies simulated with common random numbers
+**/
+void extract_paired_difference(analysis **first, analysis **second, analysis **difference, long iter_num){
+  for(long n=0; n<iter_num; n++){
+    for(int i=0; i<nodes_num; i++){
+      difference[n][i].jobs = first[n][i].jobs - second[n][i].jobs;
+      difference[n][i].interarrival = first[n][i].interarrival - second[n][i].interarrival;
+      difference[n][i].wait = first[n][i].wait - second[n][i].wait;
+      difference[n][i].delay = first[n][i].delay - second[n][i].delay;
+      difference[n][i].service = first[n][i].service - second[n][i].service;
+      difference[n][i].Ns = first[n][i].Ns - second[n][i].Ns;
+      difference[n][i].Nq = first[n][i].Nq - second[n][i].Nq;
+      difference[n][i].utilization = first[n][i].utilization - second[n][i].utilization;
+      difference[n][i].ploss = first[n][i].ploss - second[n][i].ploss;
+    }
+  }
+}
+
+/**
+* Total rate of the external arrivals, it sets the length of a batch in time
+**/
+double external_rate(double *external){
+  double rate = 0;
+  for(int i=0; i<nodes_num; i++) rate += external[i];
+  return rate;
+}
+
+/**
+* Compute the response time of a complete reservation (sum of the average waits of all nodes)
+**/
+double get_response_time(analysis *result){
+  double response = 0;
+  for(int i=0; i<nodes_num; i++) response += result[i].wait;
+  return response;
+}
+
 /**
 * Extract final statistic result from the base/resized simulation
 **/
-void extract_statistic_analysis(analysis **result, statistic_analysis *statistic_result, int mode){
-  long iter_num;
-  if (mode == finite_horizon) iter_num = REPLICAS_NUM;
-  else iter_num = BATCH_NUM;
+void extract_statistic_analysis(analysis **result, statistic_analysis *statistic_result, long iter_num){
   double u = 1.0 - (1.0 - LOC)/2;                     // interval parameter
   double t = idfStudent(iter_num - 1, u);             // critical value of t
   double diff;
@@ -355,9 +737,12 @@ void extract_statistic_analysis(analysis **result, statistic_analysis *statistic
     printf("Error allocating memory: max_wait calloc\n");
     exit(5);
   }
+  statistic_result->samples = iter_num;
+  statistic_result->warmup = -1;
+  statistic_result->antithetic = 0;
   
   // use Welford's one-pass method and standard deviation  
-  for(int i=0; i<NODES; i++){ 
+  for(int i=0; i<nodes_num; i++){ 
     statistic_result->interarrival[i][mean] = 0;
     sum.interarrival = 0;
     statistic_result->wait[i][mean] = 0;
@@ -429,7 +814,7 @@ void extract_statistic_analysis(analysis **result, statistic_analysis *statistic
   sum.max_wait = 0;
   for(int n=1; n<=iter_num; n++){
     max_wait[n-1] = 0;
-    for(int i=0; i<NODES; i++){
+    for(int i=0; i<nodes_num; i++){
       max_wait[n-1] += result[n-1][i].wait;
     }
     diff = max_wait[n-1] - statistic_result->avg_max_wait[mean];
@@ -443,15 +828,13 @@ void extract_statistic_analysis(analysis **result, statistic_analysis *statistic
     printf("ERROR - insufficient data\n");
     exit(5);
   }
+  free(max_wait);
 }
 
 /**
 * Extract final statistic result from the improved simulation
 **/
-void extract_priority_statistic_analysis(analysis **result, analysis **priority_result, statistic_analysis *statistic_result, int mode){
-  long iter_num;
-  if (mode == finite_horizon) iter_num = REPLICAS_NUM;
-  else iter_num = BATCH_NUM;
+void extract_priority_statistic_analysis(analysis **result, analysis **priority_result, statistic_analysis *statistic_result, long iter_num){
   double u = 1.0 - (1.0 - LOC)/2;                     // interval parameter
   double t = idfStudent(iter_num - 1, u);             // critical value of t
   double diff;
@@ -480,6 +863,9 @@ void extract_priority_statistic_analysis(analysis **result, analysis **priority_
     printf("Error allocating memory: max_wait calloc\n");
     exit(5);
   }
+  statistic_result->samples = iter_num;
+  statistic_result->warmup = -1;
+  statistic_result->antithetic = 0;
   
   // use Welford's one-pass method and standard deviation  
   for(int i=0; i<PRIORITY_CLASSES; i++){ 
@@ -558,7 +944,7 @@ void extract_priority_statistic_analysis(analysis **result, analysis **priority_
   for(int n=1; n<=iter_num; n++){
     for(int i=0; i<PRIORITY_CLASSES; i++){
       priority_max_wait[i][n-1] = 0;
-      for(int node=0; node<NODES-1; node++){
+      for(int node=0; node<payment_control; node++){
         priority_max_wait[i][n-1] += result[n-1][node].wait;
       }
       priority_max_wait[i][n-1] += priority_result[n-1][i].wait;
@@ -577,6 +963,71 @@ void extract_priority_statistic_analysis(analysis **result, analysis **priority_
     printf("ERROR - insufficient data\n");
     exit(5);
   }
+  free(max_wait);
+  for(int i=0; i<PRIORITY_CLASSES; i++) free(priority_max_wait[i]);
+}
+
+/**
+* Parse a comma separated list of metrics checked by the sequential stopping rule
+**/
+int parse_metrics(char *list){
+  int metrics = 0;
+  char buffer[128];
+  char *token;
+
+  snprintf(buffer, sizeof(buffer), "%s", list);
+  for(token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")){
+    if(strcmp(token, "response") == 0) metrics |= metric_response;
+    else if(strcmp(token, "ploss") == 0) metrics |= metric_ploss;
+    else if(strcmp(token, "wait") == 0) metrics |= metric_wait;
+    else return 0;
+  }
+  return metrics;
+}
+
+/**
+* Compare the relative half-width of a single statistic with the target precision
+**/
+double relative_progress(double *statistic, double precision){
+  double relative;
+
+  if(statistic[interval] == 0) return 1;
+  relative = statistic[interval] / fabs(statistic[mean]);
+  // the half-width shrinks as 1/sqrt(n), so the squared ratio estimates the fraction of work already done
+  return (precision / relative) * (precision / relative);
+}
+
+/**
+* Return the progress towards the target precision of the worst selected metric (>= 1 when reached)
+**/
+double precision_progress(statistic_analysis *result, statistic_analysis *priority_result, int metrics, double precision){
+  double progress = INFINITY;
+
+  if(metrics & metric_response){
+    progress = fmin(progress, relative_progress(result->avg_max_wait, precision));
+    if(priority_result != NULL){
+      for(int i=0; i<PRIORITY_CLASSES; i++) progress = fmin(progress, relative_progress(priority_result->priority_avg_max_wait[i], precision));
+    }
+  }
+  if(metrics & metric_ploss){
+    progress = fmin(progress, relative_progress(result->ploss[payment_control], precision));
+  }
+  if(metrics & metric_wait){
+    for(int k=0; k<nodes_num; k++) progress = fmin(progress, relative_progress(result->wait[k], precision));
+    if(priority_result != NULL){
+      for(int i=0; i<PRIORITY_CLASSES; i++) progress = fmin(progress, relative_progress(priority_result->wait[i], precision));
+    }
+  }
+
+  return progress;
+}
+
+/**
+* Print the outcome of the sequential stopping rule
+**/
+void print_precision(double precision, long iter_num, int reached){
+  if(reached) printf("Target relative precision of %.2lf%% reached after %ld replicas/batches\n\n", 100.0 * precision, iter_num);
+  else printf("Warning: target relative precision of %.2lf%% not reached within %ld replicas/batches\n\n", 100.0 * precision, iter_num);
 }
 
 /**
@@ -584,7 +1035,7 @@ void extract_priority_statistic_analysis(analysis **result, analysis **priority_
 **/
 void print_replica(analysis *result, int *servers_num){
   printf("\n");
-  for(int k=0; k<NODES; k++){
+  for(int k=0; k<nodes_num; k++){
     printf("Node %d:\n", k+1);
     printf("    processed jobs       = %ld\n", result[k].jobs);
     printf("    avg interarrival     = %lf\n", result[k].interarrival);
@@ -603,14 +1054,45 @@ void print_replica(analysis *result, int *servers_num){
   printf("\n");
 }
 
+/**
+* Mark with '*' a paired difference whose confidence interval doesn't contain zero
+**/
+char significance(double *difference){
+  return fabs(difference[mean]) > difference[interval] + 1e-9 ? '*' : ' ';
+}
+
+/**
+* Print the paired differences between two topologies
+**/
+void print_paired_difference(statistic_analysis *result, char *first, char *second){
+  printf("%s - %s:\n", first, second);
+  printf("  node          avg wait                 avg delay              avg # in node                ploss\n");
+  for(int k=0; k<nodes_num; k++){
+    printf("%6d %10.4lf +/- %8.4lf%c %10.4lf +/- %8.4lf%c %10.4lf +/- %8.4lf%c %8.4lf%% +/- %7.4lf%%%c\n", k+1,
+      result->wait[k][mean], result->wait[k][interval], significance(result->wait[k]),
+      result->delay[k][mean], result->delay[k][interval], significance(result->delay[k]),
+      result->Ns[k][mean], result->Ns[k][interval], significance(result->Ns[k]),
+      100 * result->ploss[k][mean], 100 * result->ploss[k][interval], significance(result->ploss[k]));
+  }
+  printf("  average max response time difference = %7.3lf s +/- %6.3lf s%c\n\n", result->avg_max_wait[mean], result->avg_max_wait[interval], significance(result->avg_max_wait));
+}
+
 /**
 * Print statistic result of the base/resized simulation
 **/
 void print_statistic_result(statistic_analysis *result, int mode){
-  if(mode == finite_horizon) printf("Based upon %d simulations and with %.2lf%% confidence:\n\n", REPLICAS_NUM, 100.0 * LOC);
-  else if(mode == infinite_horizon) printf("Based on a simulation split into %d batches and with %.2lf%% confidence:\n\n", BATCH_NUM, 100.0 * LOC);
+  if(mode == finite_horizon && result->antithetic) printf("Based upon %ld antithetic pairs of simulations and with %.2lf%% confidence:\n\n", result->samples, 100.0 * LOC);
+  else if(mode == finite_horizon) printf("Based upon %ld simulations and with %.2lf%% confidence:\n\n", result->samples, 100.0 * LOC);
+  else if(mode == infinite_horizon){
+    printf("Based on a simulation split into %ld batches and with %.2lf%% confidence:\n", result->samples, 100.0 * LOC);
+    if(result->batch_size > 0) printf("(batch size of %ld jobs selected by the lag-1 autocorrelation test)\n", result->batch_size);
+    if(result->warmup >= 0) printf("(first %ld jobs discarded as warm-up)\n", result->warmup);
+    printf("\n");
+  }
+  else if(mode == regenerative) printf("Based on %ld regeneration cycles and with %.2lf%% confidence (ratio estimators):\n\n", result->samples, 100.0 * LOC);
+  else if(mode == analytic) printf("Analytic solution of the network (M/M/c and M/M/c/K nodes, exact values):\n\n");
 
-  for(int k=0; k<NODES; k++){
+  for(int k=0; k<nodes_num; k++){
     printf("Node %d:\n", k+1);
     printf("    avg interarrival     = %10.6lf +/- %9.6lf\n", result->interarrival[k][mean], result->interarrival[k][interval]);
     printf("    avg wait             = %10.6lf +/- %9.6lf\n", result->wait[k][mean], result->wait[k][interval]);
@@ -631,11 +1113,18 @@ void print_statistic_result(statistic_analysis *result, int mode){
 void print_improved_statistic_result(statistic_analysis *result, statistic_analysis *priority_result, double *priority_perc, int mode){
   int k;
   
-  if(mode == finite_horizon) printf("Based on %d simulations and with %.2lf%% confidence:\n\n", REPLICAS_NUM, 100.0 * LOC);
-  else if(mode == infinite_horizon) printf("Based on a simulation splitted into %d batches and with %.2lf%% confidence:\n\n", BATCH_NUM, 100.0 * LOC);
+  if(mode == finite_horizon && result->antithetic) printf("Based on %ld antithetic pairs of simulations and with %.2lf%% confidence:\n\n", result->samples, 100.0 * LOC);
+  else if(mode == finite_horizon) printf("Based on %ld simulations and with %.2lf%% confidence:\n\n", result->samples, 100.0 * LOC);
+  else if(mode == infinite_horizon){
+    printf("Based on a simulation splitted into %ld batches and with %.2lf%% confidence:\n", result->samples, 100.0 * LOC);
+    if(result->batch_size > 0) printf("(batch size of %ld jobs selected by the lag-1 autocorrelation test)\n", result->batch_size);
+    if(result->warmup >= 0) printf("(first %ld jobs discarded as warm-up)\n", result->warmup);
+    printf("\n");
+  }
+  else if(mode == analytic) printf("Analytic solution of the network (M/M/c nodes, non-preemptive priorities at payment_control, exact values):\n\n");
   else exit(0);
 
-  for(k=0; k<NODES-1; k++){
+  for(k=0; k<payment_control; k++){
     printf("Node %d:\n", k+1);
     printf("    avg interarrival     = %10.6lf +/- %9.6lf\n", result->interarrival[k][mean], result->interarrival[k][interval]);
     printf("    avg wait             = %10.6lf +/- %9.6lf\n", result->wait[k][mean], result->wait[k][interval]);
@@ -697,7 +1186,8 @@ void save_to_csv(statistic_analysis *result, project_topology topology, int seed
   char filename[128];
 
   if(mode == finite_horizon){
-    snprintf(title, 55, "Based on %d simulations and with %.2lf%% confidence;\n\n", REPLICAS_NUM, 100.0 * LOC);
+    if(result->antithetic) snprintf(title, sizeof(title), "Based on %ld antithetic pairs of simulations and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
+    else snprintf(title, sizeof(title), "Based on %ld simulations and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
     switch(topology){
       case base:
         snprintf(filename, 44, "analysis//transient//base_transient_%03d.csv", seed);
@@ -714,7 +1204,8 @@ void save_to_csv(statistic_analysis *result, project_topology topology, int seed
     }
   }
   else if(mode == infinite_horizon){
-    snprintf(title, 78, "Based on a simulation splitted into %d batches and with %.2lf%% confidence;\n\n", BATCH_NUM, 100.0 * LOC);
+    if(result->warmup >= 0) snprintf(title, sizeof(title), "Based on a simulation splitted into %ld batches and with %.2lf%% confidence;%ld warm-up jobs discarded;\n\n", result->samples, 100.0 * LOC, result->warmup);
+    else snprintf(title, sizeof(title), "Based on a simulation splitted into %ld batches and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
     switch(topology){
       case base:
         snprintf(filename, 50, "analysis//steady_state//base_steady_state_%03d.csv", seed);
@@ -730,12 +1221,40 @@ void save_to_csv(statistic_analysis *result, project_topology topology, int seed
         break;
     }
   }
+  else if(mode == regenerative){
+    snprintf(title, sizeof(title), "Based on %ld regeneration cycles and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
+    switch(topology){
+      case base:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//base_regenerative_%03d.csv", seed);
+        break;
+      case resized:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//resized_regenerative_%03d.csv", seed);
+        break;
+      default:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//regenerative_%03d.csv", seed);
+        break;
+    }
+  }
+  else if(mode == analytic){
+    snprintf(title, sizeof(title), "Analytic solution of the network (M/M/c and M/M/c/K nodes);\n\n");
+    switch(topology){
+      case base:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//base_analytic_%03d.csv", seed);
+        break;
+      case resized:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//resized_analytic_%03d.csv", seed);
+        break;
+      default:
+        snprintf(filename, sizeof(filename), "analysis//steady_state//analytic_%03d.csv", seed);
+        break;
+    }
+  }
   else exit(0);
 
   FILE *csv = fopen(filename, "w");
   fputs(title, csv);
 
-  for(int k=0; k<NODES; k++){
+  for(int k=0; k<nodes_num; k++){
     fprintf(csv,"NODE %d;mean;;interval;\n", k+1);
     fprintf(csv,"avg interarrival;%lf;+/-;%lf;\n", result->interarrival[k][mean], result->interarrival[k][interval]);
     fprintf(csv,"avg wait;%lf;+/-;%lf;\n", result->wait[k][mean], result->wait[k][interval]);
@@ -759,19 +1278,25 @@ void save_improved_to_csv(statistic_analysis *result, statistic_analysis *priori
   char filename[128];
   int k;
   if(mode == finite_horizon && topology == improved) {
-    snprintf(title, 55, "Based on %d simulations and with %.2lf%% confidence;\n\n", REPLICAS_NUM, 100.0 * LOC);
+    if(result->antithetic) snprintf(title, sizeof(title), "Based on %ld antithetic pairs of simulations and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
+    else snprintf(title, sizeof(title), "Based on %ld simulations and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
     snprintf(filename, 48, "analysis//transient//improved_transient_%03d.csv", seed);
   }
   else if(mode == infinite_horizon && topology == improved) {
-    snprintf(title, 78, "Based on a simulation splitted into %d batches and with %.2lf%% confidence;\n\n", BATCH_NUM, 100.0 * LOC);
+    if(result->warmup >= 0) snprintf(title, sizeof(title), "Based on a simulation splitted into %ld batches and with %.2lf%% confidence;%ld warm-up jobs discarded;\n\n", result->samples, 100.0 * LOC, result->warmup);
+    else snprintf(title, sizeof(title), "Based on a simulation splitted into %ld batches and with %.2lf%% confidence;\n\n", result->samples, 100.0 * LOC);
     snprintf(filename, 54, "analysis//steady_state//improved_steady_state_%03d.csv", seed);
   }
+  else if(mode == analytic && topology == improved) {
+    snprintf(title, sizeof(title), "Analytic solution of the network (M/M/c nodes, non-preemptive priorities at payment_control);\n\n");
+    snprintf(filename, sizeof(filename), "analysis//steady_state//improved_analytic_%03d.csv", seed);
+  }
   else exit(0);
 
   FILE *csv = fopen(filename, "w");
   fputs(title, csv);
 
-  for(k=0; k<NODES-1; k++){
+  for(k=0; k<payment_control; k++){
     fprintf(csv, "NODE %d;mean;;interval;\n", k+1);
     fprintf(csv, "avg interarrival;%lf;+/-;%lf;\n", result->interarrival[k][mean], result->interarrival[k][interval]);
     fprintf(csv, "avg wait;%lf;+/-;%lf;\n", result->wait[k][mean], result->wait[k][interval]);
@@ -824,6 +1349,472 @@ void save_improved_to_csv(statistic_analysis *result, statistic_analysis *priori
   fclose(csv);
 }
 
+/**
+* Print the comparison between the variance estimators of the steady state simulation
+**/
+void print_variance_analysis(variance_analysis *result){
+  printf("\nAlternative variance estimators (%ld intervals of %d jobs, batches of %ld intervals, spectral lag %d):\n\n", result->intervals, VARIANCE_INTERVAL_SIZE, result->batch_intervals, SPECTRAL_LAGS);
+  printf("                               mean            BM       OBM  Bartlett    Parzen\n");
+  for(int k=0; k<nodes_num; k++){
+    printf("Node %d:\n", k+1);
+    printf("    avg wait             = %10.6lf +/- %9.6lf %9.6lf %9.6lf %9.6lf\n", result->wait[k][batch_means][mean], result->wait[k][batch_means][interval], result->wait[k][overlapping_batch_means][interval], result->wait[k][spectral_bartlett][interval], result->wait[k][spectral_parzen][interval]);
+    printf("    avg # in node        = %10.6lf +/- %9.6lf %9.6lf %9.6lf %9.6lf\n", result->Ns[k][batch_means][mean], result->Ns[k][batch_means][interval], result->Ns[k][overlapping_batch_means][interval], result->Ns[k][spectral_bartlett][interval], result->Ns[k][spectral_parzen][interval]);
+    printf("    ploss                = %8.4lf %% +/- %7.4lf %% %7.4lf %% %7.4lf %% %7.4lf %%\n", 100 * result->ploss[k][batch_means][mean], 100 * result->ploss[k][batch_means][interval], 100 * result->ploss[k][overlapping_batch_means][interval], 100 * result->ploss[k][spectral_bartlett][interval], 100 * result->ploss[k][spectral_parzen][interval]);
+  }
+  printf("Average max response time = %7.3lf s +/- %6.3lf s %6.3lf s %6.3lf s %6.3lf s\n", result->avg_max_wait[batch_means][mean], result->avg_max_wait[batch_means][interval], result->avg_max_wait[overlapping_batch_means][interval], result->avg_max_wait[spectral_bartlett][interval], result->avg_max_wait[spectral_parzen][interval]);
+}
+
+/**
+* Append the comparison between the variance estimators to the steady state csv
+**/
+void save_variance_to_csv(variance_analysis *result, project_topology topology, int seed){
+  char filename[128];
+
+  switch(topology){
+    case base:
+      snprintf(filename, sizeof(filename), "analysis//steady_state//base_steady_state_%03d.csv", seed);
+      break;
+    case resized:
+      snprintf(filename, sizeof(filename), "analysis//steady_state//resized_steady_state_%03d.csv", seed);
+      break;
+    case improved:
+      snprintf(filename, sizeof(filename), "analysis//steady_state//improved_steady_state_%03d.csv", seed);
+      break;
+    default:
+      snprintf(filename, sizeof(filename), "analysis//steady_state//steady_state_%03d.csv", seed);
+      break;
+  }
+
+  FILE *csv = fopen(filename, "a");
+  fprintf(csv, "\nVARIANCE ESTIMATORS;%ld intervals of %d jobs;\n", result->intervals, VARIANCE_INTERVAL_SIZE);
+  for(int k=0; k<nodes_num; k++){
+    fprintf(csv, "NODE %d;mean;BM;OBM;Bartlett;Parzen;\n", k+1);
+    fprintf(csv, "avg wait;%lf;%lf;%lf;%lf;%lf;\n", result->wait[k][batch_means][mean], result->wait[k][batch_means][interval], result->wait[k][overlapping_batch_means][interval], result->wait[k][spectral_bartlett][interval], result->wait[k][spectral_parzen][interval]);
+    fprintf(csv, "avg # in node;%lf;%lf;%lf;%lf;%lf;\n", result->Ns[k][batch_means][mean], result->Ns[k][batch_means][interval], result->Ns[k][overlapping_batch_means][interval], result->Ns[k][spectral_bartlett][interval], result->Ns[k][spectral_parzen][interval]);
+    fprintf(csv, "ploss;%.4lf%%;%.4lf%%;%.4lf%%;%.4lf%%;%.4lf%%;\n", 100 * result->ploss[k][batch_means][mean], 100 * result->ploss[k][batch_means][interval], 100 * result->ploss[k][overlapping_batch_means][interval], 100 * result->ploss[k][spectral_bartlett][interval], 100 * result->ploss[k][spectral_parzen][interval]);
+  }
+  fprintf(csv, "Average max response time:;%.4lf;%.4lf;%.4lf;%.4lf;%.4lf;\n", result->avg_max_wait[batch_means][mean], result->avg_max_wait[batch_means][interval], result->avg_max_wait[overlapping_batch_means][interval], result->avg_max_wait[spectral_bartlett][interval], result->avg_max_wait[spectral_parzen][interval]);
+  fclose(csv);
+}
+
+/**
+* Print raw and control-variate adjusted estimators side by side
+**/
+void print_control_variate_analysis(statistic_analysis *result, control_variate_analysis *cv_result){
+  printf("\nControl variates (observed - expected service and offered interarrival, %ld samples):\n\n", cv_result->samples);
+  printf("                                       raw                      adjusted\n");
+  for(int k=0; k<nodes_num; k++){
+    printf("Node %d:\n", k+1);
+    printf("    avg wait             = %10.6lf +/- %9.6lf   %10.6lf +/- %9.6lf\n", result->wait[k][mean], result->wait[k][interval], cv_result->wait[k][mean], cv_result->wait[k][interval]);
+    printf("    avg delay            = %10.6lf +/- %9.6lf   %10.6lf +/- %9.6lf\n", result->delay[k][mean], result->delay[k][interval], cv_result->delay[k][mean], cv_result->delay[k][interval]);
+    printf("    avg # in node        = %10.6lf +/- %9.6lf   %10.6lf +/- %9.6lf\n", result->Ns[k][mean], result->Ns[k][interval], cv_result->Ns[k][mean], cv_result->Ns[k][interval]);
+    printf("    ploss                = %8.4lf %% +/- %7.4lf %%   %8.4lf %% +/- %7.4lf %%\n", 100 * result->ploss[k][mean], 100 * result->ploss[k][interval], 100 * cv_result->ploss[k][mean], 100 * cv_result->ploss[k][interval]);
+  }
+  printf("Average max response time = %7.3lf s +/- %6.3lf s   %7.3lf s +/- %6.3lf s\n", result->avg_max_wait[mean], result->avg_max_wait[interval], cv_result->avg_max_wait[mean], cv_result->avg_max_wait[interval]);
+}
+
+/**
+* Append the control-variate adjusted estimators to the csv of the simulation
+**/
+void save_control_variate_to_csv(control_variate_analysis *cv_result, project_topology topology, int seed, int mode){
+  char filename[128];
+  char *names[] = {"base", "resized", "improved"};
+
+  if(mode == finite_horizon) snprintf(filename, sizeof(filename), "analysis//transient//%s_transient_%03d.csv", names[topology], seed);
+  else snprintf(filename, sizeof(filename), "analysis//steady_state//%s_steady_state_%03d.csv", names[topology], seed);
+
+  FILE *csv = fopen(filename, "a");
+  fprintf(csv, "\nCONTROL VARIATES;%ld samples;\n", cv_result->samples);
+  for(int k=0; k<nodes_num; k++){
+    fprintf(csv, "NODE %d;mean;;interval;\n", k+1);
+    fprintf(csv, "avg wait;%lf;+/-;%lf;\n", cv_result->wait[k][mean], cv_result->wait[k][interval]);
+    fprintf(csv, "avg delay;%lf;+/-;%lf;\n", cv_result->delay[k][mean], cv_result->delay[k][interval]);
+    fprintf(csv, "avg # in node;%lf;+/-;%lf;\n", cv_result->Ns[k][mean], cv_result->Ns[k][interval]);
+    fprintf(csv, "ploss;%.4lf%%;+/-;%.4lf%%;\n", 100 * cv_result->ploss[k][mean], 100 * cv_result->ploss[k][interval]);
+  }
+  fprintf(csv, "Average max response time:; %.4lf;+/-;%.4lf;\n", cv_result->avg_max_wait[mean], cv_result->avg_max_wait[interval]);
+  fclose(csv);
+}
+
+/**
+* Name of a parameter of the IPA derivatives: mu of every node, then lambda of every node
+**/
+void gradient_parameter_name(char *name, size_t size, int parameter){
+  if(parameter < NODES) snprintf(name, size, "mu[%d]", parameter + 1);
+  else snprintf(name, size, "lambda[%d]", parameter - NODES + 1);
+}
+
+/**
+* The mu of the nodes missing from the network and the lambda of the nodes without external arrivals are not shown,
+* nor any lambda in steady state
+**/
+int gradient_parameter_skipped(gradient_analysis *result, int parameter, double *rates){
+  return parameter % NODES >= nodes_num || (parameter >= NODES && (result->lambda_omitted || rates[parameter - NODES] == 0));
+}
+
+/**
+* The response time is the sum of the waits: its derivatives are biased as soon as one of the nodes is
+**/
+int gradient_response_biased(gradient_analysis *result){
+  for(int k=0; k<nodes_num; k++){
+    if(result->biased[k]) return 1;
+  }
+  return 0;
+}
+
+/**
+* Print the IPA derivatives of the waits and of the response time, next to the analytic ones if available
+**/
+void print_gradient_analysis(gradient_analysis *result, double *rates){
+  char name[16];
+
+  printf("\nIPA gradients (derivatives of the averages w.r.t. every service%s rate, %ld samples):\n\n", result->lambda_omitted ? "" : " and arrival", result->samples);
+  printf("                                       IPA%s\n", result->exact ? "                 analytic" : "");
+  for(int k=0; k<nodes_num; k++){
+    printf("Node %d avg wait%s:\n", k+1, result->biased[k] ? " (*)" : "");
+    for(int i=0; i<IPA_PARAMETERS; i++){
+      if(gradient_parameter_skipped(result, i, rates)) continue;
+      gradient_parameter_name(name, sizeof(name), i);
+      printf("    d/d %-12s     = %12.4lf +/- %10.4lf", name, result->wait[k][i][mean], result->wait[k][i][interval]);
+      if(result->exact) printf("   %12.4lf", result->exact_wait[k][i]);
+      printf("\n");
+    }
+  }
+  printf("Average max response time%s:\n", gradient_response_biased(result) ? " (*)" : "");
+  for(int i=0; i<IPA_PARAMETERS; i++){
+    if(gradient_parameter_skipped(result, i, rates)) continue;
+    gradient_parameter_name(name, sizeof(name), i);
+    printf("    d/d %-12s     = %12.4lf +/- %10.4lf", name, result->avg_max_wait[i][mean], result->avg_max_wait[i][interval]);
+    if(result->exact) printf("   %12.4lf", result->exact_avg_max_wait[i]);
+    printf("\n");
+  }
+  if(gradient_response_biased(result)) printf("(*) finite queue or priority scheduling: IPA misses the jumps of the sample path, the derivatives are biased\n");
+  if(result->lambda_omitted) printf("Derivatives w.r.t. lambda omitted in steady state: IPA has no unbiased estimator of them\n");
+}
+
+/**
+* Append the IPA derivatives to the csv of the simulation
+**/
+void save_gradient_to_csv(gradient_analysis *result, double *rates, project_topology topology, int seed, int mode){
+  char filename[128], name[16];
+  char *names[] = {"base", "resized", "improved"};
+
+  if(mode == finite_horizon) snprintf(filename, sizeof(filename), "analysis//transient//%s_transient_%03d.csv", names[topology], seed);
+  else snprintf(filename, sizeof(filename), "analysis//steady_state//%s_steady_state_%03d.csv", names[topology], seed);
+
+  FILE *csv = fopen(filename, "a");
+  fprintf(csv, "\nIPA GRADIENTS;%ld samples;\n", result->samples);
+  for(int k=0; k<nodes_num; k++){
+    fprintf(csv, "NODE %d AVG WAIT%s;mean;;interval;%s\n", k+1, result->biased[k] ? " (biased)" : "", result->exact ? "analytic;" : "");
+    for(int i=0; i<IPA_PARAMETERS; i++){
+      if(gradient_parameter_skipped(result, i, rates)) continue;
+      gradient_parameter_name(name, sizeof(name), i);
+      fprintf(csv, "d/d %s;%lf;+/-;%lf;", name, result->wait[k][i][mean], result->wait[k][i][interval]);
+      if(result->exact) fprintf(csv, "%lf;", result->exact_wait[k][i]);
+      fprintf(csv, "\n");
+    }
+  }
+  fprintf(csv, "AVERAGE MAX RESPONSE TIME%s;mean;;interval;%s\n", gradient_response_biased(result) ? " (biased)" : "", result->exact ? "analytic;" : "");
+  for(int i=0; i<IPA_PARAMETERS; i++){
+    if(gradient_parameter_skipped(result, i, rates)) continue;
+    gradient_parameter_name(name, sizeof(name), i);
+    fprintf(csv, "d/d %s;%lf;+/-;%lf;", name, result->avg_max_wait[i][mean], result->avg_max_wait[i][interval]);
+    if(result->exact) fprintf(csv, "%lf;", result->exact_avg_max_wait[i]);
+    fprintf(csv, "\n");
+  }
+  if(result->lambda_omitted) fprintf(csv, "lambda derivatives omitted in steady state;\n");
+  fclose(csv);
+}
+
+/**
+* Relative violation of the QoS targets (0 if ploss and response time are both satisfied)
+**/
+double qos_violation(server_candidate *candidate){
+  return fmax(0, candidate->ploss[mean] / QOS_MAX_PLOSS - 1) + fmax(0, candidate->response[mean] / QOS_MAX_RESPONSE - 1);
+}
+
+/**
+* Mark the simulated candidates not dominated in cost, ploss and response time
+**/
+void pareto_front(server_candidate *candidates, int n){
+  server_candidate *a, *b;
+
+  for(int i=0; i<n; i++){
+    a = &candidates[i];
+    a->pareto = a->evaluated;
+    for(int j=0; j<n && a->pareto; j++){
+      b = &candidates[j];
+      if(j == i || !b->evaluated) continue;
+      if(b->cost <= a->cost && b->ploss[mean] <= a->ploss[mean] && b->response[mean] <= a->response[mean] &&
+         (b->cost < a->cost || b->ploss[mean] < a->ploss[mean] || b->response[mean] < a->response[mean])) a->pareto = 0;
+    }
+  }
+}
+
+/**
+* Print the Pareto front of cost vs. QoS and the cheapest configuration satisfying the QoS
+**/
+void print_optimizer_result(server_candidate *candidates, int n, server_candidate *best, int *base_servers, long samples, int mode){
+  int evaluated = 0, pruned = 0, screened = 0, base_cost = 0;
+
+  for(int i=0; i<n; i++){
+    evaluated += candidates[i].evaluated;
+    pruned += !candidates[i].stable;
+    screened += candidates[i].screened;
+  }
+  for(int k=0; k<nodes_num; k++) base_cost += base_servers[k];
+  printf("Server optimizer with common random numbers on %ld %s and %.2lf%% confidence (QoS: ploss < %.2lf %%, response time < %.2lf s):\n", samples, mode == finite_horizon ? "simulations" : "batches", 100.0 * LOC, 100 * QOS_MAX_PLOSS, QOS_MAX_RESPONSE);
+  printf("%d configurations simulated, %d unstable configurations pruned, %d screened by the analytic solution\n\n", evaluated, pruned, screened);
+  printf("Pareto front of cost vs. QoS ('*' = QoS satisfied):\n");
+  printf("  cost    servers                 ploss                    response time\n");
+  for(int c=0; c<=nodes_num*OPTIMIZER_MAX_SERVERS; c++){
+    for(int i=0; i<n; i++){
+      if(!candidates[i].pareto || candidates[i].cost != c) continue;
+      printf("%6d    [", c);
+      for(int k=0; k<nodes_num; k++) printf("%3d", candidates[i].servers[k]);
+      printf(" ]   %8.4lf%% +/- %7.4lf%%   %8.3lf s +/- %7.3lf s %c\n", 100 * candidates[i].ploss[mean], 100 * candidates[i].ploss[interval],
+        candidates[i].response[mean], candidates[i].response[interval], qos_violation(&candidates[i]) == 0 ? '*' : ' ');
+    }
+  }
+  if(qos_violation(best) > 0){
+    printf("\nNo configuration with at most %d servers per node satisfies the QoS\n\n", OPTIMIZER_MAX_SERVERS);
+    return;
+  }
+  printf("\nCheapest configuration satisfying the QoS: [");
+  for(int k=0; k<nodes_num; k++) printf("%3d", best->servers[k]);
+  printf(" ] with %d servers (%+d w.r.t. BASE)\n\n", best->cost, best->cost - base_cost);
+}
+
+/**
+* Print the configurations ranked by the KN procedure and the selected one
+**/
+void print_selection_result(selection_system *systems, int k, int selected, int identified){
+  long total = 0;
+
+  for(int i=0; i<k; i++) total += systems[i].observations;
+  printf("Ranking and selection (KN) of the lowest response time among %d configurations with %d servers:\n", k, systems[0].candidate->cost);
+  printf("(probability of correct selection %.2lf%%, indifference zone %.3lf s, %ld observations instead of %ld with equal allocation)\n\n",
+    100 * SELECTION_PCS, SELECTION_INDIFFERENCE, total, k * systems[selected].observations);
+  printf("    servers             observations     avg response time\n");
+  for(int i=0; i<k; i++){
+    printf("  [");
+    for(int j=0; j<nodes_num; j++) printf("%3d", systems[i].candidate->servers[j]);
+    printf(" ]   %12ld       %12.4lf s     %s\n", systems[i].observations, systems[i].response, i == selected ? "selected" : (systems[i].eliminated ? "eliminated" : "not eliminated"));
+  }
+  if(!identified) printf("\nThe observation budget ran out before a single configuration was left\n");
+  printf("\n");
+}
+
+/**
+* Report the replicas/batches taken from the result cache instead of being simulated
+**/
+void print_cache_usage(long reused, long executed, char *filename){
+  printf("Result cache: %ld of %ld replicas/batches reused from %s\n\n", reused, executed, filename);
+}
+
+/**
+* Compare the simulated estimates with the analytic values ('*' = analytic value outside the confidence interval)
+**/
+void print_validation(statistic_analysis *result, statistic_analysis *exact){
+  printf("Validation against the analytic solution ('*' = analytic value outside the confidence interval):\n");
+  printf("  node        avg wait (sim / exact)           avg # in node (sim / exact)         ploss (sim / exact)\n");
+  for(int k=0; k<nodes_num; k++){
+    printf("%6d %10.4lf +/- %7.4lf %10.4lf%c %10.4lf +/- %7.4lf %10.4lf%c %8.4lf%% +/- %7.4lf%% %8.4lf%%%c\n", k+1,
+      result->wait[k][mean], result->wait[k][interval], exact->wait[k][mean], fabs(result->wait[k][mean] - exact->wait[k][mean]) > result->wait[k][interval] ? '*' : ' ',
+      result->Ns[k][mean], result->Ns[k][interval], exact->Ns[k][mean], fabs(result->Ns[k][mean] - exact->Ns[k][mean]) > result->Ns[k][interval] ? '*' : ' ',
+      100 * result->ploss[k][mean], 100 * result->ploss[k][interval], 100 * exact->ploss[k][mean], fabs(result->ploss[k][mean] - exact->ploss[k][mean]) > result->ploss[k][interval] ? '*' : ' ');
+  }
+  printf("  average max response time = %7.3lf s +/- %6.3lf s   exact %7.3lf s%c\n\n", result->avg_max_wait[mean], result->avg_max_wait[interval], exact->avg_max_wait[mean],
+    fabs(result->avg_max_wait[mean] - exact->avg_max_wait[mean]) > result->avg_max_wait[interval] ? '*' : ' ');
+}
+
+/**
+* Compare the simulated class-wise estimates with the CTMC solution of payment_control
+**/
+void print_priority_validation(statistic_analysis *priority_result, statistic_analysis *exact){
+  printf("Validation of the priority classes against the CTMC of payment_control ('*' = exact value outside the confidence interval):\n");
+  printf("  class       avg wait (sim / exact)           avg # in node (sim / exact)\n");
+  for(int i=0; i<PRIORITY_CLASSES; i++){
+    printf("%6d %10.4lf +/- %7.4lf %10.4lf%c %10.4lf +/- %7.4lf %10.4lf%c\n", i+1,
+      priority_result->wait[i][mean], priority_result->wait[i][interval], exact->wait[i][mean], fabs(priority_result->wait[i][mean] - exact->wait[i][mean]) > priority_result->wait[i][interval] ? '*' : ' ',
+      priority_result->Ns[i][mean], priority_result->Ns[i][interval], exact->Ns[i][mean], fabs(priority_result->Ns[i][mean] - exact->Ns[i][mean]) > priority_result->Ns[i][interval] ? '*' : ' ');
+  }
+  printf("\n");
+}
+
+/**
+* Print the size and convergence of the priority CTMC (and the class-wise waits of Cobham's formula if available)
+**/
+void print_ctmc_analysis(ctmc_analysis *ctmc, double elapsed, statistic_analysis *priority_result, statistic_analysis *reference){
+  printf("\nPriority CTMC of payment_control: %ld states, %ld transitions, %ld Gauss-Seidel sweeps in %.3lf ms\n", ctmc->states, ctmc->transitions, ctmc->sweeps, elapsed);
+  printf("(residual %e, probability of a %s queue %e)\n", ctmc->residual, ctmc->truncated ? "truncated" : "full", ctmc->boundary);
+  if(reference == NULL) return;
+  for(int i=0; i<PRIORITY_CLASSES; i++){
+    printf("    class[%d] avg wait    = %10.6lf (Cobham's formula %10.6lf)\n", i+1, priority_result->wait[i][mean], reference->wait[i][mean]);
+  }
+}
+
+/**
+* Print crude and importance sampling estimates of the payment_control ploss, next to the M/M/c/K one
+**/
+void print_rare_event_analysis(rare_event_analysis *result){
+  printf("Rare-event estimation of the payment_control ploss with %.2lf%% confidence:\n", 100.0 * LOC);
+  printf("(%ld plain cycles, %ld cycles with %ld excursions over all the servers busy, with arrival rate %lf -> %lf and service rate %lf -> %lf until their first rejection)\n\n", result->plain_cycles, result->tilted_cycles, result->tilted_excursions, result->rate, result->tilted_rate, result->mu, result->tilted_mu);
+  printf("                                     ploss                     relative error    M/M/c/K in the interval\n");
+  printf("    crude                = %12.6e +/- %12.6e     %8.4lf %%       %s\n", result->plain_ploss[mean], result->plain_ploss[interval], result->plain_ploss[mean] > 0 ? 100 * result->plain_ploss[interval] / result->plain_ploss[mean] : 100.0, fabs(result->plain_ploss[mean] - result->analytic) <= result->plain_ploss[interval] ? "yes" : "no");
+  printf("    importance sampling  = %12.6e +/- %12.6e     %8.4lf %%       %s\n", result->ploss[mean], result->ploss[interval], result->ploss[mean] > 0 ? 100 * result->ploss[interval] / result->ploss[mean] : 100.0, fabs(result->ploss[mean] - result->analytic) <= result->ploss[interval] ? "yes" : "no");
+  printf("    analytic M/M/c/K     = %12.6e\n", result->analytic);
+}
+
+/**
+* Save crude and importance sampling estimates of the payment_control ploss
+**/
+void save_rare_event_to_csv(rare_event_analysis *result, project_topology topology, int seed){
+  char filename[128];
+  char *names[] = {"base", "resized", "improved"};
+
+  snprintf(filename, sizeof(filename), "analysis//steady_state//%s_rare_event_%03d.csv", names[topology], seed);
+  FILE *csv = fopen(filename, "w");
+  fprintf(csv, "Rare-event estimation of the payment_control ploss with %.2lf%% confidence;%ld plain cycles;%ld tilted cycles;%ld tilted excursions;tilted arrival rate;%lf;tilted service rate;%lf;\n\n", 100.0 * LOC, result->plain_cycles, result->tilted_cycles, result->tilted_excursions, result->tilted_rate, result->tilted_mu);
+  fprintf(csv, "estimator;mean;;interval;\n");
+  fprintf(csv, "crude;%e;+/-;%e;\n", result->plain_ploss[mean], result->plain_ploss[interval]);
+  fprintf(csv, "importance sampling;%e;+/-;%e;\n", result->ploss[mean], result->ploss[interval]);
+  fprintf(csv, "analytic M/M/c/K;%e;\n", result->analytic);
+  fclose(csv);
+}
+
+void save_optimizer_to_csv(server_candidate *candidates, int n, server_candidate *best, int seed, int mode){
+  char filename[128];
+
+  if(mode == finite_horizon) snprintf(filename, sizeof(filename), "analysis//transient//optimizer_%03d.csv", seed);
+  else snprintf(filename, sizeof(filename), "analysis//steady_state//optimizer_%03d.csv", seed);
+
+  FILE *csv = fopen(filename, "w");
+  fprintf(csv, "Server optimizer with common random numbers and %.2lf%% confidence;QoS ploss;%.4lf%%;QoS response time;%.4lf;\n\n", 100.0 * LOC, 100 * QOS_MAX_PLOSS, QOS_MAX_RESPONSE);
+  fprintf(csv, "servers;;;;cost;stable;ploss;;interval;response time;;interval;QoS;pareto;\n");
+  for(int i=0; i<n; i++){
+    for(int k=0; k<nodes_num; k++) fprintf(csv, "%d;", candidates[i].servers[k]);
+    fprintf(csv, "%d;%d;", candidates[i].cost, candidates[i].stable);
+    if(candidates[i].evaluated) fprintf(csv, "%.4lf%%;+/-;%.4lf%%;%.4lf;+/-;%.4lf;%d;%d;\n", 100 * candidates[i].ploss[mean], 100 * candidates[i].ploss[interval],
+      candidates[i].response[mean], candidates[i].response[interval], qos_violation(&candidates[i]) == 0, candidates[i].pareto);
+    else fprintf(csv, ";;;;;;;;\n");
+  }
+  if(qos_violation(best) == 0){
+    fprintf(csv, "\ncheapest configuration;");
+    for(int k=0; k<nodes_num; k++) fprintf(csv, "%d;", best->servers[k]);
+    fprintf(csv, "%d;\n", best->cost);
+  }
+  fclose(csv);
+}
+
+void save_selection_to_csv(selection_system *systems, int k, int selected, int identified, int seed, int mode){
+  char filename[128];
+
+  if(mode == finite_horizon) snprintf(filename, sizeof(filename), "analysis//transient//optimizer_%03d.csv", seed);
+  else snprintf(filename, sizeof(filename), "analysis//steady_state//optimizer_%03d.csv", seed);
+
+  FILE *csv = fopen(filename, "a");
+  fprintf(csv, "\nRanking and selection (KN);PCS;%.4lf;indifference zone;%.4lf;identified;%d;\n", SELECTION_PCS, SELECTION_INDIFFERENCE, identified);
+  fprintf(csv, "servers;;;;observations;avg response time;selected;eliminated at;\n");
+  for(int i=0; i<k; i++){
+    for(int j=0; j<nodes_num; j++) fprintf(csv, "%d;", systems[i].candidate->servers[j]);
+    fprintf(csv, "%ld;%.4lf;%d;%ld;\n", systems[i].observations, systems[i].response, i == selected, systems[i].eliminated);
+  }
+  fclose(csv);
+}
+
+/**
+* Save the paired differences between the topologies simulated with common random numbers
+**/
+void save_comparison_to_csv(statistic_analysis *result, char **first, char **second, int comparisons, int seed, int mode){
+  char filename[128];
+
+  if(mode == finite_horizon) snprintf(filename, sizeof(filename), "analysis//transient//comparison_%03d.csv", seed);
+  else snprintf(filename, sizeof(filename), "analysis//steady_state//comparison_%03d.csv", seed);
+
+  FILE *csv = fopen(filename, "w");
+  fprintf(csv, "Paired differences on %ld %s with common random numbers and %.2lf%% confidence;\n\n", result[0].samples, mode == finite_horizon ? "simulations" : "batches", 100.0 * LOC);
+  for(int c=0; c<comparisons; c++){
+    fprintf(csv, "%s - %s;\n", first[c], second[c]);
+    for(int k=0; k<nodes_num; k++){
+      fprintf(csv, "NODE %d;mean;;interval;\n", k+1);
+      fprintf(csv, "avg wait;%lf;+/-;%lf;\n", result[c].wait[k][mean], result[c].wait[k][interval]);
+      fprintf(csv, "avg delay;%lf;+/-;%lf;\n", result[c].delay[k][mean], result[c].delay[k][interval]);
+      fprintf(csv, "avg # in node;%lf;+/-;%lf;\n", result[c].Ns[k][mean], result[c].Ns[k][interval]);
+      fprintf(csv, "avg # in queue;%lf;+/-;%lf;\n", result[c].Nq[k][mean], result[c].Nq[k][interval]);
+      fprintf(csv, "avg utilizzation;%lf;+/-;%lf;\n", result[c].utilization[k][mean], result[c].utilization[k][interval]);
+      fprintf(csv, "ploss;%.4lf%%;+/-;%.4lf%%;\n", 100 * result[c].ploss[k][mean], 100 * result[c].ploss[k][interval]);
+    }
+    fprintf(csv, "Average max response time:; %.4lf;+/-;%.4lf;\n\n", result[c].avg_max_wait[mean], result[c].avg_max_wait[interval]);
+  }
+  fclose(csv);
+}
+
+/**
+* Print the speed and the memory of the engine for every size of the mesh
+**/
+void print_mesh_benchmark(mesh_benchmark *result, int sizes){
+  printf("Mesh benchmark: %d external arrivals at %.1lf jobs/s, servers sized for %.0lf%% utilization\n\n", MESH_BENCHMARK_JOBS, MESH_EXTERNAL_RATE, 100 * MESH_UTILIZATION);
+  printf("     nodes      edges  classes       events   CPU time (s)     events/s   state B/node   peak B/node   population     wait      ploss\n");
+  for(int i=0; i<sizes; i++){
+    printf("%10d %10ld %8d %12ld %14.3lf %12.0lf %14.1lf %13.1lf %12.4lf %8.4lf %9.4lf%%\n", result[i].nodes, result[i].edges, result[i].classes, result[i].events, result[i].seconds,
+      result[i].seconds > 0 ? result[i].events / result[i].seconds : 0, result[i].state_bytes, result[i].peak_bytes, result[i].population, result[i].wait, 100 * result[i].ploss);
+  }
+}
+
+void save_mesh_benchmark_to_csv(mesh_benchmark *result, int sizes, int seed){
+  char filename[128];
+
+  snprintf(filename, sizeof(filename), "analysis//benchmark//mesh_benchmark_%03d.csv", seed);
+  FILE *csv = fopen(filename, "w");
+  fprintf(csv, "Mesh benchmark;external arrivals;%d;rate;%lf;utilization;%lf;\n\n", MESH_BENCHMARK_JOBS, MESH_EXTERNAL_RATE, MESH_UTILIZATION);
+  fprintf(csv, "nodes;edges;classes;events;CPU time (s);events/s;state bytes per node;peak bytes per node;population;wait;ploss;\n");
+  for(int i=0; i<sizes; i++){
+    fprintf(csv, "%d;%ld;%d;%ld;%lf;%lf;%lf;%lf;%lf;%lf;%lf%%;\n", result[i].nodes, result[i].edges, result[i].classes, result[i].events, result[i].seconds,
+      result[i].seconds > 0 ? result[i].events / result[i].seconds : 0, result[i].state_bytes, result[i].peak_bytes, result[i].population, result[i].wait, 100 * result[i].ploss);
+  }
+  fclose(csv);
+}
+
+/**
+* Print the time-bucketed metrics of the FINITE runs with time-varying arrival rates
+**/
+void print_time_buckets(time_bucket *buckets, long n, long candidates, long rejected){
+  double u = 1.0 - (1.0 - LOC)/2;
+  double t = idfStudent(n - 1, u);
+  double width = RATE_PERIOD / RATE_BUCKETS, half[BUCKET_METRICS];
+
+  printf("\nTime-varying arrivals: %ld candidates, %ld rejected by the thinning (%.2lf%%)\n", candidates, rejected, candidates > 0 ? 100.0 * rejected / candidates : 0);
+  printf("Metrics of every %.0lf min of the day, based upon %ld simulations and with %.2lf%% confidence:\n\n", width / 60, n, 100.0 * LOC);
+  printf(" from (h)  profile rate        arrival rate            # in system           response time     payment_control ploss\n");
+  for(int b=0; b<RATE_BUCKETS; b++){
+    for(int m=0; m<BUCKET_METRICS; m++) half[m] = t * sqrt(buckets[b].sum[m] / n) / sqrt(n - 1);
+    printf("%9.2lf %13.4lf  %8.4lf +/- %7.4lf  %9.4lf +/- %8.4lf  %9.4lf +/- %8.4lf  %7.3lf %% +/- %6.3lf %%\n", b * width / RATE_HOUR, buckets[b].expected,
+      buckets[b].mean[bucket_arrivals], half[bucket_arrivals], buckets[b].mean[bucket_population], half[bucket_population],
+      buckets[b].mean[bucket_response], half[bucket_response], 100 * buckets[b].mean[bucket_ploss], 100 * half[bucket_ploss]);
+  }
+}
+
+void save_time_buckets_to_csv(time_bucket *buckets, long n, project_topology topology, int seed){
+  char *names[3] = {"base", "resized", "improved"};
+  char filename[128];
+  double u = 1.0 - (1.0 - LOC)/2;
+  double t = idfStudent(n - 1, u);
+  double width = RATE_PERIOD / RATE_BUCKETS, half[BUCKET_METRICS];
+
+  snprintf(filename, sizeof(filename), "analysis//transient//%s_buckets_%03d.csv", names[topology], seed);
+  FILE *csv = fopen(filename, "w");
+  fprintf(csv, "Based on %ld simulations and with %.2lf%% confidence;bucket (s);%lf;\n\n", n, 100.0 * LOC, width);
+  fprintf(csv, "from (h);profile rate;arrival rate;+/-;jobs in system;+/-;response time;+/-;payment_control ploss;+/-;\n");
+  for(int b=0; b<RATE_BUCKETS; b++){
+    for(int m=0; m<BUCKET_METRICS; m++) half[m] = t * sqrt(buckets[b].sum[m] / n) / sqrt(n - 1);
+    fprintf(csv, "%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf;%lf%%;%lf%%;\n", b * width / RATE_HOUR, buckets[b].expected,
+      buckets[b].mean[bucket_arrivals], half[bucket_arrivals], buckets[b].mean[bucket_population], half[bucket_population],
+      buckets[b].mean[bucket_response], half[bucket_response], 100 * buckets[b].mean[bucket_ploss], 100 * half[bucket_ploss]);
+  }
+  fclose(csv);
+}
+
 /**
 * Build, update and complete the progress bar
 **/
@@ -1,12 +1,36 @@
 #include "utils.c"
 
-node_id SwitchNode(double*, node_id);
-int SelectPriorityClass(int, double*);
-int SelectServer(node_stats);
+double AntitheticRandom(int);
+int node_stream(node_id, int);
+void save_streams(long*);
+void restore_streams(long*);
+node_id SwitchNode(route_table*, node_id, int);
+node_id RouteNode(route_table*, node_id, double);
+void init_priority_table(priority_table*, int, double*);
+void free_priority_table(priority_table*);
+int SelectPriorityClass(priority_table*, int);
+int ClassifyPriority(priority_table*, double);
+void build_alias(double*, int, double*, int*);
+int alias_sample(double*, int*, int, double);
+void add_route(route_table*, node_id, double);
+void close_route(route_table*);
+void default_routes(double*, route_table*);
+void routing_matrix(route_table*, double[NODES][NODES]);
+void traffic_equations(double*, route_table*, double*);
+void init_idle_servers(node_stats*);
+int SelectServer(node_stats*);
+void ReleaseServer(node_stats*, int);
 event* GenerateEvent(event_type, node_id, int, double);
 void InsertEvent(event**, event*);
 event* ExtractEvent(event**);
+event* RemoveEvent(event**, event_type, node_id, int);
 job* GenerateJob(double, double, int);
+job* GenerateProfileJob(double, node_id, double*, priority_table*);
+job* GenerateLogJob(double, node_id, double*, priority_table*, double*);
+job* CopyProfileJob(job*);
+job* GenerateTraceJob(trace_arrival*);
+job* RouteJob(job*, double, node_id);
+void FreeJob(job*);
 void InsertJob(job**, job*);
 void InsertPriorityJob(job**, job*);
 job* ExtractJob(job**);
@@ -14,16 +38,54 @@ job* ExtractJob(job**);
 void extract_analysis(analysis*, node_stats*, time_integrated*, int*, double, double*);
 void extract_priority_analysis(analysis*, node_stats*, time_integrated*, int, double, double*);
 
-void extract_statistic_analysis(analysis**, statistic_analysis*, int);
-void extract_priority_statistic_analysis(analysis**, analysis**, statistic_analysis*, int);
+void merge_analysis(analysis*, analysis*, analysis*, int);
+void extract_paired_difference(analysis**, analysis**, analysis**, long);
+double external_rate(double*);
+double get_response_time(analysis*);
+void extract_statistic_analysis(analysis**, statistic_analysis*, long);
+void extract_priority_statistic_analysis(analysis**, analysis**, statistic_analysis*, long);
+
+int parse_metrics(char*);
+double relative_progress(double*, double);
+double precision_progress(statistic_analysis*, statistic_analysis*, int, double);
+void print_precision(double, long, int);
 
 void print_replica(analysis*, int*);
 void print_statistic_result(statistic_analysis*, int);
 void print_improved_statistic_result(statistic_analysis*, statistic_analysis*, double*, int);
+char significance(double*);
+void print_paired_difference(statistic_analysis*, char*, char*);
+void print_control_variate_analysis(statistic_analysis*, control_variate_analysis*);
+void gradient_parameter_name(char*, size_t, int);
+int gradient_parameter_skipped(gradient_analysis*, int, double*);
+int gradient_response_biased(gradient_analysis*);
+void print_gradient_analysis(gradient_analysis*, double*);
+void print_cache_usage(long, long, char*);
+void print_validation(statistic_analysis*, statistic_analysis*);
+void print_priority_validation(statistic_analysis*, statistic_analysis*);
+void print_ctmc_analysis(ctmc_analysis*, double, statistic_analysis*, statistic_analysis*);
+void print_rare_event_analysis(rare_event_analysis*);
+double qos_violation(server_candidate*);
+void pareto_front(server_candidate*, int);
+void print_optimizer_result(server_candidate*, int, server_candidate*, int*, long, int);
+void print_selection_result(selection_system*, int, int, int);
 
 void save_to_csv(statistic_analysis*, project_topology, int, int);
 void save_improved_to_csv(statistic_analysis*, statistic_analysis*, project_topology, int, int);
 
 void reset_stats(node_stats*, time_integrated*, double*);
 void reset_priority_stats(node_stats*, time_integrated*);
+void clear_nodes(node_stats*, time_integrated*, int);
+void print_variance_analysis(variance_analysis*);
+void save_variance_to_csv(variance_analysis*, project_topology, int);
+void save_comparison_to_csv(statistic_analysis*, char**, char**, int, int, int);
+void save_control_variate_to_csv(control_variate_analysis*, project_topology, int, int);
+void save_gradient_to_csv(gradient_analysis*, double*, project_topology, int, int);
+void save_rare_event_to_csv(rare_event_analysis*, project_topology, int);
+void save_optimizer_to_csv(server_candidate*, int, server_candidate*, int, int);
+void save_selection_to_csv(selection_system*, int, int, int, int, int);
+void print_mesh_benchmark(mesh_benchmark*, int);
+void save_mesh_benchmark_to_csv(mesh_benchmark*, int, int);
+void print_time_buckets(time_bucket*, long, long, long);
+void save_time_buckets_to_csv(time_bucket*, long, project_topology, int);
 void loading_bar(double);
\ No newline at end of file
@@ -14,16 +14,31 @@
 
 #include "config.h"
 #include "lib/utils.h"
-
-double lambda[3][NODES] = {{1.9, 0.8, 0.0, 0.0}, {1.9, 0.8, 0.0, 0.0}, {1.9, 0.8, 0.0, 0.0}};
-double mu[3][NODES] = {{1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}, {1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}, {1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}};
-int servers_num[3][NODES] = {{4, 4, 2, 2}, {5, 6, 3, 4}, {5, 6, 3, 4}};
-unsigned long queue_len[3][NODES] = { {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, 8}, 
-                                      {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, 8},
-                                      {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY}
-                                    };
+#include "lib/estimators.h"
+#include "lib/analytic.h"
+#include "lib/cache.h"
+#include "lib/arrival_rates.h"
+#include "lib/model.h"
+#include "lib/arrival_log.h"
+#include "lib/mesh.h"
+
+double topology_lambda[3][NODES] = {{1.9, 0.8, 0.0, 0.0}, {1.9, 0.8, 0.0, 0.0}, {1.9, 0.8, 0.0, 0.0}};
+double topology_mu[3][NODES] = {{1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}, {1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}, {1.0/2, 1.0/3.2, 1.0/2.5, 1.0/1.3}};
+int topology_servers[3][NODES] = {{4, 4, 2, 2}, {5, 6, 3, 4}, {5, 6, 3, 4}};
+unsigned long topology_queue[3][NODES] = { {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, 8}, 
+                                           {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, 8},
+                                           {INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY, INFINITE_CAPACITY}
+                                         };
+// parameters read by the engine: the rows of the topologies, a benchmark mesh points them to its own runtime-sized arrays
+double *lambda[3] = {topology_lambda[0], topology_lambda[1], topology_lambda[2]};
+double *mu[3] = {topology_mu[0], topology_mu[1], topology_mu[2]};
+int *servers_num[3] = {topology_servers[0], topology_servers[1], topology_servers[2]};
+unsigned long *queue_len[3] = {topology_queue[0], topology_queue[1], topology_queue[2]};
 double p[3] = {0.65, 0.2, 0.4};
+route_table topology_routes[NODES];
+route_table *routes = topology_routes;  // routing of every node, compiled from p or read from the model file
 double priority_probs[PRIORITY_CLASSES] = {0.8569, 0.1431};
+priority_table class_table;             // selection of the priority class, built from priority_probs
 
 int seed = 17;
 unsigned long external_arrivals;
@@ -33,15 +48,55 @@ double priority_batch_arrival[PRIORITY_CLASSES] = {START, START};
 double current_time = START;
 node_stats *priority_classes;
 time_integrated *priority_areas;
+node_id priority_node = payment_control;  // node ordering its queue by priority class in the improved topology
 
 int mode;
 double stop_time;
+double horizon;                         // stop time of the mode, before --adaptive-batch and --precision extend it
 long iter_num;
 int batch_size;
+int warmup = 0;
+int adaptive = 0;
+int variance = 0;
+double precision = 0;
+int precision_metrics = metric_response | metric_ploss;
+int compare = 0;
+int optimize = 0;
+int selection = 0;
+int validate = 0;
+int use_cache = 1;
+int incremental = 0;
+char *model_file = NULL;
+char *arrival_file = NULL;
+arrival_log request_log;                // requests replayed as external arrivals instead of the Poisson streams
+arrival_rates rates[NODES];             // daily rate profiles of the external arrivals, read from the model file
+int time_varying = 0;                   // 1 if a node has a rate profile
+time_bucket buckets[RATE_BUCKETS];      // time-bucketed metrics of the day
+bucket_mark bucket_start;               // counters of the replica at the start of the current bucket
+int bucket_index;
+double bucket_end = INFINITY;           // end of the current bucket, never reached without rate profiles
+long entered_jobs = 0;                  // external arrivals of the replica
+int mesh = 0;
+int mesh_nodes = 0;                      // 0 to measure every size from MESH_MIN_NODES to MESH_MAX_NODES
+int mesh_classes = MESH_CLASSES;
+incremental_trace trace;                // arrivals at payment_control recorded or replayed by the current topology
+int antithetic = 0;
+int control = 0;
+int gradient = 0;
+double external_derivative[NODES];      // IPA derivatives w.r.t. lambda of the next external arrival at every node
+double routed_derivative[IPA_PARAMETERS];   // IPA derivatives of the departure routed to the next node
+int tilting = 0;                        // 1 while payment_control runs with swapped arrival and service rates
+double tilted_mu;
+int antithetic_replica = 0;             // 1 in the second replica of an antithetic pair
+long pair_seeds[2][RNG_STREAMS];        // streams at the start and at the end of the first replica of the pair
+job *routed_job = NULL;     // job moving to the next node with common random numbers
+int job_profiles = 0;                   // jobs draw their random numbers at the entry and move through the nodes (COMPARE and arrival logs)
 project_topology topology;
 
 double GetInterArrival(node_id);
 double GetService(node_id);
+job* GenerateExternalJob(node_id, double);
+event* NextExternalArrival(node_id, double);
 void process_arrival(event**, double, node_stats*, int, int);
 void process_arrival_priority(event**, double, node_stats*, int, int);
 void process_departure(event**, double, node_stats*, int, int);
@@ -50,14 +105,66 @@ void execute_replica(event**, node_stats*, time_integrated*);
 void execute_replica_priority(event**, node_stats*, time_integrated*); 
 void execute_batch(event**, node_stats*, time_integrated*, int, int);
 void execute_batch_priority(event**, node_stats*, time_integrated*, int, int);
+long execute_warmup(event**, node_stats*, time_integrated*);
+int execute_adaptive_batches(event**, node_stats*, time_integrated*, analysis**, analysis**);
+void execute_batch_intervals(event**, node_stats*, time_integrated*, int, interval_stream*);
+void execute_regenerative(event**, node_stats*, time_integrated*, interval_stream*);
+void route_job(event**, double, node_stats*, int, int);
+void execute_topology(analysis**);
+unsigned long long trace_key(void);
+double upstream_end_time(node_stats*);
+void execute_replay(analysis**, incremental_trace*);
+void replay_departures(event**, node_stats*, time_integrated*, double);
+void advance_replay(node_stats*, time_integrated*, double);
+void execute_comparison(void);
+void execute_lockstep(lockstep_instance*, int);
+void load_instance(lockstep_instance*);
+void save_instance(lockstep_instance*);
+void init_instance(lockstep_instance*);
+void advance_instance(lockstep_instance*, double);
+void integrate_instance(lockstep_instance*, double);
+void feed_instance(lockstep_instance*, event*, job*);
+void execute_optimizer(void);
+int add_candidate(server_candidate*, int*, int*, double*);
+void evaluate_candidates(server_candidate*, int*, int);
+void simulate_candidates(server_candidate**, int);
+void execute_selection(server_candidate*, int, int);
+double observe_system(selection_system*);
+void execute_analytic(void);
+void apply_model(char*);
+void apply_arrival_log(char*);
+void execute_mesh_benchmark(void);
+void execute_mesh(mesh_network*, mesh_benchmark*);
+unsigned long long cache_key(void);
+void init_cache_state(cache_state*, event**, node_stats*, time_integrated*);
+long load_cache(result_cache*, analysis**, analysis**, cache_state*, long*, double*);
+void store_cache(result_cache*, analysis**, analysis**, long, cache_state*, long, long);
+void report_validation(statistic_analysis*, statistic_analysis*);
+void prepare_antithetic_replica(int);
+long merge_antithetic_pairs(analysis**, analysis**, long);
+void report_control_variates(analysis**, long, statistic_analysis*);
+void init_buckets(void);
+void close_bucket(node_stats*, time_integrated*);
+void record_buckets(node_stats*, time_integrated*);
+void report_time_buckets(long);
+void arrival_derivative(job*, node_id, int);
+void start_derivative(server_totals*, double*, job*, node_id);
+void depart_derivative(node_stats*, int);
+void record_gradient(gradient_sample*, node_stats*);
+void report_gradients(gradient_sample*, long);
+void analytic_gradient(gradient_analysis*);
+double rare_event_load(void);
+void execute_rare_event(event**, node_stats*, time_integrated*, rare_event_analysis*);
+void resample_services(event**, node_stats*, node_id);
+double check_precision(analysis**, analysis**, long, statistic_analysis*, statistic_analysis*);
 void init_event_list(event**);
-void init_servers(server_stats**, int);
+void init_servers(node_stats*, int);
 void init_nodes(node_stats**);
 void init_priority_nodes(node_stats**, node_id);
 void init_areas(time_integrated**);
 void init_priority_areas(time_integrated**);
-void init_result(analysis***);
-void init_priority_result(analysis***);
+void init_result(analysis***, long);
+void init_priority_result(analysis***, long);
 
 
 int main(int argc, char *argv[])
@@ -66,13 +173,21 @@ int main(int argc, char *argv[])
   node_stats *nodes;
   time_integrated *areas;
   node_id actual_node;
-  int actual_server, current_batch = 0;
-  analysis **result, **priority_result;
+  int actual_server, current_batch = 0, mesh_options = 0;
+  long executed, reused, discarded = 0;
+  double progress;
+  analysis **result, **priority_result = NULL;
   statistic_analysis statistic_result, priority_statistic_result;
+  interval_stream stream;
+  variance_analysis variance_result;
+  rare_event_analysis rare_result;
+  result_cache cache;
+  cache_state run_state;
+  gradient_sample *gradients = NULL;
 
   fflush(stdout);
-  if(argc != 3){
-    printf("Usage: ./simulation <BASE/RESIZED/IMPROVED> <FINITE|INFINITE>\n");
+  if(argc < 3){
+    printf("Usage: ./simulation <BASE/RESIZED/IMPROVED/COMPARE/OPTIMIZE/MESH> <FINITE|INFINITE|REGENERATIVE|RARE|ANALYTIC|BENCHMARK> [--warmup] [--adaptive-batch] [--variance] [--antithetic] [--control-variates] [--gradient] [--select] [--validate] [--no-cache] [--incremental] [--model <file>] [--arrivals <log.csv|log.bin>] [--precision <relative half-width>] [--metrics <response,ploss,wait>] [--nodes <N>] [--classes <K>]\n");
     exit(0);
   }
   if(strcmp(argv[1], "BASE") == 0){
@@ -84,8 +199,23 @@ int main(int argc, char *argv[])
   else if(strcmp(argv[1], "IMPROVED") == 0){
     topology = improved;
   }
+  else if(strcmp(argv[1], "COMPARE") == 0){
+    topology = base;
+    compare = 1;
+  }
+  else if(strcmp(argv[1], "OPTIMIZE") == 0){
+    // candidates are simulated on the resized network (finite payment_control queue) with the same jobs
+    topology = resized;
+    compare = 1;
+    optimize = 1;
+  }
+  else if(strcmp(argv[1], "MESH") == 0){
+    // synthetic networks sized at runtime, simulated by the engine of the improved topology
+    topology = improved;
+    mesh = 1;
+  }
   else{
-    printf("Specify the topology: BASE or RESIZED or IMPROVED\n");
+    printf("Specify the topology: BASE or RESIZED or IMPROVED or COMPARE or OPTIMIZE or MESH\n");
     exit(0);
   }
   if(strcmp(argv[2], "FINITE") == 0){
@@ -99,80 +229,364 @@ int main(int argc, char *argv[])
     iter_num = BATCH_NUM;
     batch_size = BATCH_SIZE;
   }
+  else if(strcmp(argv[2], "REGENERATIVE") == 0){
+    mode = regenerative;
+    stop_time = INFINITE_HORIZON_STOP;
+    iter_num = 1;
+  }
+  else if(strcmp(argv[2], "RARE") == 0){
+    mode = rare_event;
+    stop_time = INFINITE_HORIZON_STOP;
+    iter_num = 1;
+  }
+  else if(strcmp(argv[2], "ANALYTIC") == 0){
+    mode = analytic;
+    iter_num = 0;
+  }
+  else if(strcmp(argv[2], "BENCHMARK") == 0){
+    mode = benchmark;
+    iter_num = 0;
+  }
   else{
-    printf("Specify the simulation mode: FINITE or INFINITE\n");
+    printf("Specify the simulation mode: FINITE or INFINITE or REGENERATIVE or RARE or ANALYTIC or BENCHMARK\n");
+    exit(0);
+  }
+  for(int i=3; i<argc; i++){
+    if(strcmp(argv[i], "--warmup") == 0){
+      warmup = 1;
+    }
+    else if(strcmp(argv[i], "--adaptive-batch") == 0){
+      adaptive = 1;
+    }
+    else if(strcmp(argv[i], "--variance") == 0){
+      variance = 1;
+    }
+    else if(strcmp(argv[i], "--antithetic") == 0){
+      antithetic = 1;
+    }
+    else if(strcmp(argv[i], "--control-variates") == 0){
+      control = 1;
+    }
+    else if(strcmp(argv[i], "--gradient") == 0){
+      gradient = 1;
+    }
+    else if(strcmp(argv[i], "--select") == 0){
+      selection = 1;
+    }
+    else if(strcmp(argv[i], "--validate") == 0){
+      validate = 1;
+    }
+    else if(strcmp(argv[i], "--no-cache") == 0){
+      use_cache = 0;
+    }
+    else if(strcmp(argv[i], "--incremental") == 0){
+      incremental = 1;
+    }
+    else if(strcmp(argv[i], "--model") == 0 && i+1 < argc){
+      model_file = argv[++i];
+    }
+    else if(strcmp(argv[i], "--arrivals") == 0 && i+1 < argc){
+      arrival_file = argv[++i];
+    }
+    else if(strcmp(argv[i], "--precision") == 0 && i+1 < argc){
+      precision = atof(argv[++i]);
+      if(precision <= 0 || precision >= 1){
+        printf("The relative precision must be between 0 and 1\n");
+        exit(0);
+      }
+    }
+    else if(strcmp(argv[i], "--metrics") == 0 && i+1 < argc){
+      precision_metrics = parse_metrics(argv[++i]);
+      if(precision_metrics == 0){
+        printf("Specify the metrics as a comma separated list of: response, ploss, wait\n");
+        exit(0);
+      }
+    }
+    else if(strcmp(argv[i], "--nodes") == 0 && i+1 < argc && mesh){
+      mesh_nodes = atoi(argv[++i]);
+      mesh_options += 2;
+      if(mesh_nodes < 2){
+        printf("The mesh needs at least 2 nodes\n");
+        exit(0);
+      }
+    }
+    else if(strcmp(argv[i], "--classes") == 0 && i+1 < argc && mesh){
+      mesh_classes = atoi(argv[++i]);
+      mesh_options += 2;
+      if(mesh_classes < 1){
+        printf("The mesh needs at least 1 priority class\n");
+        exit(0);
+      }
+    }
+    else{
+      printf("Unknown option: %s\n", argv[i]);
+      exit(0);
+    }
+  }
+  if(mesh != (mode == benchmark) || (mesh && argc > 3 + mesh_options)){
+    printf("BENCHMARK is available only for the MESH topology, with --nodes and --classes as the only options\n");
+    exit(0);
+  }
+  if(antithetic && (mode != finite_horizon || compare || precision > 0)){
+    printf("Antithetic pairs are available only in FINITE mode without sequential stopping\n");
+    exit(0);
+  }
+  if(mode == rare_event && queue_len[topology][payment_control] == INFINITE_CAPACITY){
+    printf("Rare-event mode requires a finite queue at payment_control\n");
+    exit(0);
+  }
+  if(mode == rare_event && (warmup || adaptive || variance || antithetic || control || precision > 0 || compare)){
+    printf("Options are not available in RARE mode\n");
+    exit(0);
+  }
+  if(control && (mode == regenerative || compare)){
+    printf("Control variates are available only in FINITE or INFINITE mode\n");
+    exit(0);
+  }
+  if(gradient && ((mode != finite_horizon && mode != infinite_horizon) || compare || adaptive || antithetic)){
+    printf("IPA gradients are available only in FINITE or INFINITE mode without adaptive batches and antithetic pairs\n");
+    exit(0);
+  }
+  if(optimize && (mode == regenerative || mode == rare_event || warmup || adaptive || variance || antithetic || control || precision > 0)){
+    printf("OPTIMIZE is available only in FINITE or INFINITE mode without options\n");
+    exit(0);
+  }
+  if(mode == analytic && (argc > 3 + 2*(model_file != NULL) || compare)){
+    printf("ANALYTIC is available only for BASE, RESIZED and IMPROVED topologies without options\n");
+    exit(0);
+  }
+  if(validate && (compare || (mode != infinite_horizon && mode != regenerative))){
+    printf("Validation against the analytic solution is available only in INFINITE or REGENERATIVE mode\n");
+    exit(0);
+  }
+  if(incremental && !compare){
+    printf("Incremental re-simulation of payment_control is available only with COMPARE or OPTIMIZE\n");
+    exit(0);
+  }
+  if(model_file != NULL && compare && !optimize){
+    printf("COMPARE uses the compiled topologies, a model file is available only for BASE, RESIZED, IMPROVED and OPTIMIZE\n");
+    exit(0);
+  }
+  if(arrival_file != NULL && (compare || (mode != finite_horizon && mode != infinite_horizon) || antithetic || control || gradient)){
+    printf("Trace-driven arrivals are available only for BASE, RESIZED and IMPROVED in FINITE or INFINITE mode without antithetic pairs, control variates and gradients\n");
+    exit(0);
+  }
+  if(selection && !optimize){
+    printf("Ranking and selection is available only with OPTIMIZE\n");
+    exit(0);
+  }
+  if(compare && (mode == regenerative || warmup || adaptive || variance || precision > 0)){
+    printf("COMPARE is available only in FINITE or INFINITE mode without options\n");
     exit(0);
   }
+  if(mode == regenerative && topology == improved){
+    printf("Regenerative mode is available only for BASE and RESIZED topologies\n");
+    exit(0);
+  }
+  if(mode == regenerative && precision > 0){
+    printf("Sequential stopping is not available in REGENERATIVE mode\n");
+    exit(0);
+  }
+  if(warmup && mode != infinite_horizon){
+    printf("Warm-up detection is available only in INFINITE mode\n");
+    exit(0);
+  }
+  if(adaptive && mode != infinite_horizon){
+    printf("Adaptive batch sizing is available only in INFINITE mode\n");
+    exit(0);
+  }
+  if(adaptive && precision > 0){
+    printf("Adaptive batch sizing and sequential stopping can't be used together\n");
+    exit(0);
+  }
+  if(variance && (mode != infinite_horizon || adaptive)){
+    printf("Alternative variance estimators are available only in INFINITE mode with fixed batch size\n");
+    exit(0);
+  }
+  horizon = stop_time;
+  if(adaptive){
+    // the run length depends on the selected batch size, the horizon only bounds the largest one
+    batch_size = ADAPTIVE_MIN_BATCH_SIZE;
+    stop_time = INFINITE_HORIZON_STOP * ADAPTIVE_MAX_BATCH_SIZE / BATCH_SIZE;
+  }
+  if(precision > 0){
+    // replicas/batches are added until the target precision, iter_num is only the upper bound
+    iter_num = SEQUENTIAL_MAX_ITER;
+    if(mode == infinite_horizon) stop_time = INFINITE_HORIZON_STOP * SEQUENTIAL_MAX_ITER / BATCH_NUM;
+  }
+
+  if(mode == benchmark){
+    execute_mesh_benchmark();
+    return 0;
+  }
+
+  // the routing tables are compiled once, a model file replaces the parameters of the selected topology
+  default_routes(p, routes);
+  if(model_file != NULL) apply_model(model_file);
+  if(nodes_num > COMPILED_NODES && (topology == improved || compare || arrival_file != NULL)){
+    printf("Nodes added by a model file are available only for BASE and RESIZED, without COMPARE, OPTIMIZE and arrival logs\n");
+    exit(0);
+  }
+  if((incremental || mode == analytic || mode == rare_event) && (routes[payment_control].fanout != 1 || routes[payment_control].destination[0] != outside)){
+    printf("--incremental, ANALYTIC and RARE require payment_control to be the last node of every job\n");
+    exit(0);
+  }
+  if(time_varying && (mode != finite_horizon || compare || antithetic || control || gradient || arrival_file != NULL)){
+    printf("Time-varying arrival rates are available only for BASE, RESIZED and IMPROVED in FINITE mode without antithetic pairs, control variates, gradients and arrival logs\n");
+    exit(0);
+  }
+  if(mode == rare_event && rare_event_load() >= 1){
+    printf("Rare-event mode requires a payment_control load below 1: the tilted cycles swap its arrival and service rates\n");
+    exit(0);
+  }
+  init_priority_table(&class_table, PRIORITY_CLASSES, priority_probs);
+  if(arrival_file != NULL) apply_arrival_log(arrival_file);
+  job_profiles = compare || arrival_file != NULL;
+  
+  if(mode == analytic){
+    execute_analytic();
+    return 0;
+  }
   
   PlantSeeds(seed);
 
+  // plain runs reuse the replicas/batches stored by previous runs of the same configuration
+  cache.enabled = use_cache && (mode == finite_horizon || mode == infinite_horizon) && !compare && !antithetic && !adaptive && !variance && !gradient && arrival_file == NULL && !time_varying;
+  if(cache.enabled) open_cache(&cache, cache_key());
+
   printf("Simulation in progress, please wait\n");
   loading_bar(0.0);
 
+  if(optimize){
+    execute_optimizer();
+    return 0;
+  }
+  if(compare){
+    execute_comparison();
+    return 0;
+  }
+  if(gradient){
+    job_derivatives = IPA_PARAMETERS;
+    gradients = calloc(iter_num, sizeof(gradient_sample));
+    if(gradients == NULL){
+      printf("Error allocating memory: gradients calloc\n");
+      exit(5);
+    }
+  }
+
   switch(mode){
     case finite_horizon:
       if(topology == improved){
-        init_result(&result);
-        init_priority_result(&priority_result);
-        for(int rep=0; rep<iter_num; rep++){
+        init_result(&result, iter_num);
+        init_priority_result(&priority_result, iter_num);
+        init_cache_state(&run_state, &event_list, NULL, NULL);
+        reused = load_cache(&cache, result, priority_result, &run_state, &discarded, &progress);
+        executed = reused;
+        for(int rep=reused; rep<iter_num && progress < 1; rep++){
+          if(antithetic) prepare_antithetic_replica(rep);
           external_arrivals = 0;
           init_event_list(&event_list);
           init_nodes(&nodes);
           init_priority_nodes(&priority_classes, payment_control);
           init_areas(&areas);
           init_priority_areas(&priority_areas);
+          if(time_varying) init_buckets();
 
           // execute a single simulation run
           execute_replica_priority(&event_list, nodes, areas);
+          if(time_varying) record_buckets(nodes, areas);
           
           // extract analysis data from the single replica
           extract_analysis(result[rep], nodes, areas, servers_num[topology], current_time, NULL);
+          if(gradient) record_gradient(&gradients[rep], nodes);
           extract_priority_analysis(priority_result[rep], priority_classes, priority_areas, servers_num[topology][payment_control], current_time, NULL);
           
           // free memory
           free(areas);
           free(nodes);
 
+          // with sequential stopping, stop as soon as the selected metrics reach the target precision
+          executed = rep + 1;
+          progress = (double)executed/iter_num;
+          if(precision > 0 && executed >= SEQUENTIAL_MIN_ITER){
+            progress = fmax(progress, check_precision(result, priority_result, executed, &statistic_result, &priority_statistic_result));
+          }
+
           // update loading bar
-          loading_bar((double)(rep+1)/iter_num);
+          loading_bar(fmin(progress, 1.0));
+          if(progress >= 1) break;
         }
+        store_cache(&cache, result, priority_result, executed, &run_state, discarded, reused);
+
+        // every antithetic pair becomes a single sample
+        if(antithetic) executed = merge_antithetic_pairs(result, priority_result, executed);
 
         // extract statistic analysis data from the entire simulation
-        extract_statistic_analysis(result, &statistic_result, mode);
-        extract_priority_statistic_analysis(result, priority_result, &priority_statistic_result, mode);
+        extract_statistic_analysis(result, &statistic_result, executed);
+        extract_priority_statistic_analysis(result, priority_result, &priority_statistic_result, executed);
+        statistic_result.antithetic = antithetic;
+        priority_statistic_result.antithetic = antithetic;
 
         // print output and save analysis to csv
+        if(precision > 0) print_precision(precision, executed, precision_progress(&statistic_result, &priority_statistic_result, precision_metrics, precision) >= 1);
         print_improved_statistic_result(&statistic_result, &priority_statistic_result, priority_probs, mode);
         save_improved_to_csv(&statistic_result, &priority_statistic_result, topology, seed, mode);
+        if(control) report_control_variates(result, executed, &statistic_result);
+        if(gradient) report_gradients(gradients, executed);
+        if(time_varying) report_time_buckets(executed);
       }
       else{
-        init_result(&result);
-        for(int rep=0; rep<iter_num; rep++){
+        init_result(&result, iter_num);
+        init_cache_state(&run_state, &event_list, NULL, NULL);
+        reused = load_cache(&cache, result, NULL, &run_state, &discarded, &progress);
+        executed = reused;
+        for(int rep=reused; rep<iter_num && progress < 1; rep++){
+          if(antithetic) prepare_antithetic_replica(rep);
           external_arrivals = 0;
           init_event_list(&event_list);
           init_nodes(&nodes);
           init_areas(&areas);
+          if(time_varying) init_buckets();
 
           // execute a single simulation run
           execute_replica(&event_list, nodes, areas);
+          if(time_varying) record_buckets(nodes, areas);
                     
           // extract analysis data from the single replica
           extract_analysis(result[rep], nodes, areas, servers_num[topology], current_time, NULL);
+          if(gradient) record_gradient(&gradients[rep], nodes);
           
           // free memory
           free(areas);
           free(nodes);
 
+          // with sequential stopping, stop as soon as the selected metrics reach the target precision
+          executed = rep + 1;
+          progress = (double)executed/iter_num;
+          if(precision > 0 && executed >= SEQUENTIAL_MIN_ITER){
+            progress = fmax(progress, check_precision(result, priority_result, executed, &statistic_result, &priority_statistic_result));
+          }
+
           // update loading bar
-          loading_bar((double)(rep+1)/iter_num);
+          loading_bar(fmin(progress, 1.0));
+          if(progress >= 1) break;
         }
+        store_cache(&cache, result, NULL, executed, &run_state, discarded, reused);
+
+        // every antithetic pair becomes a single sample
+        if(antithetic) executed = merge_antithetic_pairs(result, NULL, executed);
 
         // extract statistic analysis data from the entire simulation
-        extract_statistic_analysis(result, &statistic_result, mode);
+        extract_statistic_analysis(result, &statistic_result, executed);
+        statistic_result.antithetic = antithetic;
 
         // print output and save analysis to csv
+        if(precision > 0) print_precision(precision, executed, precision_progress(&statistic_result, NULL, precision_metrics, precision) >= 1);
         print_statistic_result(&statistic_result, mode);
         save_to_csv(&statistic_result, topology, seed, mode);
+        if(control) report_control_variates(result, executed, &statistic_result);
+        if(gradient) report_gradients(gradients, executed);
+        if(time_varying) report_time_buckets(executed);
       }
       
       break;
@@ -180,8 +594,8 @@ int main(int argc, char *argv[])
 
     case infinite_horizon:
       if(topology == improved){
-        init_result(&result);
-        init_priority_result(&priority_result);
+        init_result(&result, iter_num);
+        init_priority_result(&priority_result, iter_num);
         init_event_list(&event_list);
         init_nodes(&nodes);
         init_priority_nodes(&priority_classes, payment_control);
@@ -190,53 +604,168 @@ int main(int argc, char *argv[])
 
         int current_batch = 0;
         external_arrivals = 0;
+        init_cache_state(&run_state, &event_list, nodes, areas);
+        reused = load_cache(&cache, result, priority_result, &run_state, &discarded, &progress);
+        executed = reused;
+
+        // discard the initial transient (already discarded by the cached run)
+        if(warmup && reused == 0) discarded = execute_warmup(&event_list, nodes, areas);
+        if(variance) init_interval_stream(&stream, iter_num * (BATCH_SIZE / VARIANCE_INTERVAL_SIZE), current_time);
 
         // execute and extract statistic result from every single batch
-        double batch_period = (BATCH_SIZE / (lambda[topology][0] + lambda[topology][1]));
-        for(int k=0; k<iter_num; k++){
-          execute_batch_priority(&event_list, nodes, areas, batch_size, k);
+        double batch_period = (BATCH_SIZE / external_rate(lambda[topology]));
+        if(adaptive){
+          batch_size = execute_adaptive_batches(&event_list, nodes, areas, result, priority_result);
+          executed = iter_num;
+        }
+        for(int k=reused; k<iter_num && !adaptive && progress < 1; k++){
+          if(variance) execute_batch_intervals(&event_list, nodes, areas, k, &stream);
+          else execute_batch_priority(&event_list, nodes, areas, batch_size, k);
           extract_analysis(result[k], nodes, areas, servers_num[topology], batch_period, first_batch_arrival);
           extract_priority_analysis(priority_result[k], priority_classes, priority_areas, servers_num[topology][payment_control], batch_period, first_batch_arrival);
+          if(gradient) record_gradient(&gradients[k], nodes);
           reset_stats(nodes, areas, first_batch_arrival);
           reset_priority_stats(priority_classes, priority_areas);
-          loading_bar((double)(k+1)/iter_num);
+
+          // with sequential stopping, stop as soon as the selected metrics reach the target precision
+          executed = k + 1;
+          progress = (double)executed/iter_num;
+          if(precision > 0 && executed >= SEQUENTIAL_MIN_ITER){
+            progress = fmax(progress, check_precision(result, priority_result, executed, &statistic_result, &priority_statistic_result));
+          }
+          loading_bar(fmin(progress, 1.0));
+          if(progress >= 1) break;
         }
+        store_cache(&cache, result, priority_result, executed, &run_state, discarded, reused);
 
         // extract statistic analysis data from the entire simulation
-        extract_statistic_analysis(result, &statistic_result, mode);
-        extract_priority_statistic_analysis(result, priority_result, &priority_statistic_result, mode);
+        extract_statistic_analysis(result, &statistic_result, executed);
+        extract_priority_statistic_analysis(result, priority_result, &priority_statistic_result, executed);
+        statistic_result.warmup = warmup ? discarded : -1;
+        priority_statistic_result.warmup = warmup ? discarded : -1;
+        statistic_result.batch_size = adaptive ? batch_size : 0;
+        priority_statistic_result.batch_size = statistic_result.batch_size;
 
         // print output and save analysis to csv
+        if(precision > 0) print_precision(precision, executed, precision_progress(&statistic_result, &priority_statistic_result, precision_metrics, precision) >= 1);
         print_improved_statistic_result(&statistic_result, &priority_statistic_result, priority_probs, mode);
         save_improved_to_csv(&statistic_result, &priority_statistic_result, topology, seed, mode);
+        if(control) report_control_variates(result, executed, &statistic_result);
+        if(gradient) report_gradients(gradients, executed);
+        if(validate) report_validation(&statistic_result, &priority_statistic_result);
+
+        // compare the variance estimators computed on the interval stream
+        if(variance){
+          extract_variance_analysis(&stream, &variance_result, BATCH_SIZE / VARIANCE_INTERVAL_SIZE);
+          print_variance_analysis(&variance_result);
+          save_variance_to_csv(&variance_result, topology, seed);
+          free_interval_stream(&stream);
+        }
       }
       else{
-        init_result(&result);
+        init_result(&result, iter_num);
         init_event_list(&event_list);
         init_nodes(&nodes);
         init_areas(&areas);
         int current_batch = 0;
         external_arrivals = 0;
+        init_cache_state(&run_state, &event_list, nodes, areas);
+        reused = load_cache(&cache, result, NULL, &run_state, &discarded, &progress);
+        executed = reused;
+
+        // discard the initial transient (already discarded by the cached run)
+        if(warmup && reused == 0) discarded = execute_warmup(&event_list, nodes, areas);
+        if(variance) init_interval_stream(&stream, iter_num * (BATCH_SIZE / VARIANCE_INTERVAL_SIZE), current_time);
 
         // execute and extract statistic result from every single batch
-        for (int k=0; k<iter_num; k++) {
-          execute_batch(&event_list, nodes, areas, batch_size, k);
-          extract_analysis(result[k], nodes, areas, servers_num[topology], (BATCH_SIZE / (lambda[topology][0] + lambda[topology][1])), first_batch_arrival);
-          loading_bar((double)(k+1)/iter_num);
+        if(adaptive){
+          batch_size = execute_adaptive_batches(&event_list, nodes, areas, result, NULL);
+          executed = iter_num;
+        }
+        for (int k=reused; k<iter_num && !adaptive && progress < 1; k++) {
+          if(variance) execute_batch_intervals(&event_list, nodes, areas, k, &stream);
+          else execute_batch(&event_list, nodes, areas, batch_size, k);
+          extract_analysis(result[k], nodes, areas, servers_num[topology], (BATCH_SIZE / external_rate(lambda[topology])), first_batch_arrival);
+          if(gradient) record_gradient(&gradients[k], nodes);
           reset_stats(nodes, areas, first_batch_arrival);
+
+          // with sequential stopping, stop as soon as the selected metrics reach the target precision
+          executed = k + 1;
+          progress = (double)executed/iter_num;
+          if(precision > 0 && executed >= SEQUENTIAL_MIN_ITER){
+            progress = fmax(progress, check_precision(result, priority_result, executed, &statistic_result, &priority_statistic_result));
+          }
+          loading_bar(fmin(progress, 1.0));
+          if(progress >= 1) break;
         }
+        store_cache(&cache, result, NULL, executed, &run_state, discarded, reused);
 
         // extract statistic analysis data from the entire simulation
-        extract_statistic_analysis(result, &statistic_result, mode);
+        extract_statistic_analysis(result, &statistic_result, executed);
+        statistic_result.warmup = warmup ? discarded : -1;
+        statistic_result.batch_size = adaptive ? batch_size : 0;
 
         // print output and save analysis to csv
+        if(precision > 0) print_precision(precision, executed, precision_progress(&statistic_result, NULL, precision_metrics, precision) >= 1);
         print_statistic_result(&statistic_result, mode);
         save_to_csv(&statistic_result, topology, seed, mode);
+        if(control) report_control_variates(result, executed, &statistic_result);
+        if(gradient) report_gradients(gradients, executed);
+        if(validate) report_validation(&statistic_result, NULL);
+
+        // compare the variance estimators computed on the interval stream
+        if(variance){
+          extract_variance_analysis(&stream, &variance_result, BATCH_SIZE / VARIANCE_INTERVAL_SIZE);
+          print_variance_analysis(&variance_result);
+          save_variance_to_csv(&variance_result, topology, seed);
+          free_interval_stream(&stream);
+        }
       }
       
       break;
 
 
+    case rare_event:
+      init_event_list(&event_list);
+      init_nodes(&nodes);
+      init_areas(&areas);
+      external_arrivals = 0;
+
+      // a single run where plain and tilted payment_control cycles alternate
+      execute_rare_event(&event_list, nodes, areas, &rare_result);
+      loading_bar(1.0);
+
+      // print output and save analysis to csv
+      extract_rare_event_analysis(&rare_result);
+      print_rare_event_analysis(&rare_result);
+      save_rare_event_to_csv(&rare_result, topology, seed);
+
+      break;
+
+
+    case regenerative:
+      init_event_list(&event_list);
+      init_nodes(&nodes);
+      init_areas(&areas);
+      init_interval_stream(&stream, REGENERATIVE_MIN_CYCLES, current_time);
+      external_arrivals = 0;
+
+      // a single run split into the cycles between consecutive empty-system regenerations
+      execute_regenerative(&event_list, nodes, areas, &stream);
+      loading_bar(1.0);
+
+      // extract ratio estimators from the cycle sums
+      extract_regenerative_analysis(&stream, &statistic_result, servers_num[topology]);
+      free_interval_stream(&stream);
+
+      // print output and save analysis to csv
+      print_statistic_result(&statistic_result, mode);
+      save_to_csv(&statistic_result, topology, seed, mode);
+      if(validate) report_validation(&statistic_result, NULL);
+      
+      break;
+
+
     default:
       break;
   }
@@ -245,25 +774,59 @@ int main(int argc, char *argv[])
 }
 
 double GetInterArrival(node_id k){
-  SelectStream(20*k);
-  return Exponential(1.0/lambda[topology][k]);
+  SelectStream(node_stream(k, 0));
+  return idfExponential(1.0/lambda[topology][k], AntitheticRandom(antithetic_replica));
 }
    
+/**
+* Job entering the system with all its random numbers, the service demands of a replayed request come from the log
+**/
+job* GenerateExternalJob(node_id k, double time){
+  if(request_log.map != NULL) return GenerateLogJob(time, k, mu[topology], &class_table, request_services(&request_log));
+  return GenerateProfileJob(time, k, mu[topology], &class_table);
+}
+
+/**
+* Next external arrival: the next request of the log, the next arrival thinned from the rate profile of the node or the next
+* arrival of its Poisson stream
+**/
+event* NextExternalArrival(node_id k, double time){
+  log_request *request;
+
+  if(request_log.map != NULL){
+    advance_arrival_log(&request_log);
+    request = current_request(&request_log);
+    return GenerateEvent(job_arrival, request->entry, outside, request_log.offset + request->time);
+  }
+  if(time_varying && rates[k].points > 0){
+    SelectStream(node_stream(k, 0));
+    return GenerateEvent(job_arrival, k, outside, ThinnedArrival(&rates[k], time));
+  }
+  return GenerateEvent(job_arrival, k, outside, time + GetInterArrival(k));
+}
+
 double GetService(node_id k){                 
-  SelectStream(20*(NODES+k));
-  return Exponential(1.0/(mu[topology][k]));    
+  SelectStream(node_stream(k, 1));
+  // importance sampling: the tilted cycles serve payment_control at the swapped rate, making the overflow likely
+  if(tilting && k == payment_control) return idfExponential(1.0/tilted_mu, Random());
+  return idfExponential(1.0/(mu[topology][k]), AntitheticRandom(antithetic_replica));    
 }
 
 void process_arrival(event **list, double current_time, node_stats *nodes, int actual_node, int actual_server) {
   job *job = NULL;
   event *new_dep, *new_arr;
   
+  if(job_profiles && actual_server == outside) routed_job = GenerateExternalJob(actual_node, current_time);
+
   if(nodes[actual_node].node_jobs < nodes[actual_node].total_servers + queue_len[topology][actual_node]){ // there is available space in queue
-    job = GenerateJob(current_time, GetService(actual_node), 0);
+    if(job_profiles) job = RouteJob(routed_job, current_time, actual_node);
+    else job = GenerateJob(current_time, GetService(actual_node), 0);
+    if(gradient) arrival_derivative(job, actual_node, actual_server);
     if(nodes[actual_node].node_jobs < nodes[actual_node].total_servers){
-      int selected_server = SelectServer(nodes[actual_node]); // find available server
+      int selected_server = SelectServer(&nodes[actual_node]); // find available server
       nodes[actual_node].servers[selected_server].status = busy;
       nodes[actual_node].servers[selected_server].serving_job = job;
+      if(gradient) start_derivative(&nodes[actual_node].totals[selected_server], job->derivative, job, actual_node);
       new_dep = GenerateEvent(job_departure, actual_node, selected_server, current_time + job->service);
       InsertEvent(list, new_dep);
     }
@@ -276,10 +839,13 @@ void process_arrival(event **list, double current_time, node_stats *nodes, int a
   }
   else { // reject the job
     nodes[actual_node].rejected_jobs++;
+    if(job_profiles) FreeJob(routed_job);
   }
 
   if(actual_server == outside){ // generate next arrival event and schedule on condition
-    new_arr = GenerateEvent(job_arrival, actual_node, outside, current_time + GetInterArrival(actual_node));
+    entered_jobs++;
+    new_arr = NextExternalArrival(actual_node, current_time);
+    if(gradient) external_derivative[actual_node] -= (new_arr->time - current_time) / lambda[topology][actual_node];
     if(new_arr->time < stop_time && external_arrivals < max_processable_jobs){
       InsertEvent(list, new_arr);
       external_arrivals++;
@@ -291,18 +857,23 @@ void process_arrival_priority(event **list, double current_time, node_stats *nod
   job *new_job = NULL;
   event *new_dep, *new_arr;
 
+  if(job_profiles && actual_server == outside) routed_job = GenerateExternalJob(actual_node, current_time);
+
   if(nodes[actual_node].node_jobs < nodes[actual_node].total_servers + queue_len[topology][actual_node]){ // there is availble space in queue
-    new_job = GenerateJob(current_time, GetService(actual_node), SelectPriorityClass(PRIORITY_CLASSES, priority_probs));
+    if(job_profiles) new_job = RouteJob(routed_job, current_time, actual_node);
+    else new_job = GenerateJob(current_time, GetService(actual_node), SelectPriorityClass(&class_table, antithetic_replica));
+    if(gradient) arrival_derivative(new_job, actual_node, actual_server);
     if(nodes[actual_node].node_jobs < nodes[actual_node].total_servers){
-      int selected_server = SelectServer(nodes[actual_node]); // find available server
+      int selected_server = SelectServer(&nodes[actual_node]); // find available server
       nodes[actual_node].servers[selected_server].status = busy;
       nodes[actual_node].servers[selected_server].serving_job = new_job;
+      if(gradient) start_derivative(&nodes[actual_node].totals[selected_server], new_job->derivative, new_job, actual_node);
       new_dep = GenerateEvent(job_departure, actual_node, selected_server, current_time + new_job->service);
       InsertEvent(list, new_dep);
     }
     else { // insert job in queue
-      if(actual_node == payment_control){
-        InsertPriorityJob(&(nodes[payment_control].queue), new_job);
+      if(actual_node == priority_node){
+        InsertPriorityJob(&(nodes[priority_node].queue), new_job);
         priority_classes[new_job->priority].queue_jobs++;
       }
       else{
@@ -312,17 +883,20 @@ void process_arrival_priority(event **list, double current_time, node_stats *nod
     }
     nodes[actual_node].node_jobs++;
     nodes[actual_node].last_arrival = current_time;
-    if(actual_node == payment_control){
+    if(actual_node == priority_node){
       priority_classes[new_job->priority].node_jobs++;
       priority_classes[new_job->priority].last_arrival = current_time;
     }
   }
   else { // reject the job
     nodes[actual_node].rejected_jobs++;
+    if(job_profiles) FreeJob(routed_job);
   }
 
   if(actual_server == outside){
-    new_arr = GenerateEvent(job_arrival, actual_node, outside, current_time + GetInterArrival(actual_node)); // generate next arrival event
+    entered_jobs++;
+    new_arr = NextExternalArrival(actual_node, current_time); // generate next arrival event
+    if(gradient) external_derivative[actual_node] -= (new_arr->time - current_time) / lambda[topology][actual_node];
     if(new_arr->time < stop_time && external_arrivals < max_processable_jobs){ // schedule event only on condition
       InsertEvent(list, new_arr);
       external_arrivals++;
@@ -334,28 +908,36 @@ void process_departure(event **list, double current_time, node_stats *nodes, int
   job *job = NULL;
   event *new_dep, *new_arr;
   double service = nodes[actual_node].servers[actual_server].serving_job->service;
-  nodes[actual_node].servers[actual_server].service_time += service;
-  nodes[actual_node].servers[actual_server].served_jobs++;
+  nodes[actual_node].totals[actual_server].service_time += service;
+  nodes[actual_node].totals[actual_server].served_jobs++;
   nodes[actual_node].servers[actual_server].last_departure_time = current_time;
 
   nodes[actual_node].processed_jobs++;
   nodes[actual_node].node_jobs--;
-  free(nodes[actual_node].servers[actual_server].serving_job);
+  if(gradient) depart_derivative(&nodes[actual_node], actual_server);
+  if(job_profiles) routed_job = nodes[actual_node].servers[actual_server].serving_job;
+  else free(nodes[actual_node].servers[actual_server].serving_job);
 
   if(nodes[actual_node].queue_jobs > 0){
     job = ExtractJob(&(nodes[actual_node].queue));
     nodes[actual_node].servers[actual_server].serving_job = job;
     nodes[actual_node].queue_jobs--;
+    if(gradient) start_derivative(&nodes[actual_node].totals[actual_server], routed_derivative, job, actual_node);
 
     new_dep = GenerateEvent(job_departure, actual_node, actual_server, current_time + job->service);
     InsertEvent(list, new_dep);
   }
   else{
     nodes[actual_node].servers[actual_server].status = idle;
+    ReleaseServer(&nodes[actual_node], actual_server);
   }
   
-  new_arr = GenerateEvent(job_arrival, SwitchNode(p, actual_node), actual_server, current_time);
-  InsertEvent(list, new_arr);
+  // with common random numbers the job itself moves to the next node, as an arrival processed right now
+  if(job_profiles) route_job(list, current_time, nodes, actual_node, actual_server);
+  else{
+    new_arr = GenerateEvent(job_arrival, SwitchNode(routes, actual_node, antithetic_replica), actual_server, current_time);
+    InsertEvent(list, new_arr);
+  }
 }
 
 void process_departure_priority(event **list, double current_time, node_stats *nodes, int actual_node, int actual_server) {
@@ -363,29 +945,32 @@ void process_departure_priority(event **list, double current_time, node_stats *n
   event *new_dep, *new_arr;
   job *serving_job = nodes[actual_node].servers[actual_server].serving_job;
 
-  nodes[actual_node].servers[actual_server].service_time += serving_job->service;
-  nodes[actual_node].servers[actual_server].served_jobs++;
+  nodes[actual_node].totals[actual_server].service_time += serving_job->service;
+  nodes[actual_node].totals[actual_server].served_jobs++;
   nodes[actual_node].servers[actual_server].last_departure_time = current_time;
 
   nodes[actual_node].processed_jobs++;
   nodes[actual_node].node_jobs--;
+  if(gradient) depart_derivative(&nodes[actual_node], actual_server);
 
-  if(actual_node == payment_control){
-    priority_classes[serving_job->priority].servers[actual_server].service_time += serving_job->service;
-    priority_classes[serving_job->priority].servers[actual_server].served_jobs++;
+  if(actual_node == priority_node){
+    priority_classes[serving_job->priority].totals[actual_server].service_time += serving_job->service;
+    priority_classes[serving_job->priority].totals[actual_server].served_jobs++;
     priority_classes[serving_job->priority].servers[actual_server].last_departure_time = current_time;
     
     priority_classes[serving_job->priority].processed_jobs++;
     priority_classes[serving_job->priority].node_jobs--;
   }
 
-  free(nodes[actual_node].servers[actual_server].serving_job);
+  if(job_profiles) routed_job = nodes[actual_node].servers[actual_server].serving_job;
+  else free(nodes[actual_node].servers[actual_server].serving_job);
 
   if(nodes[actual_node].queue_jobs > 0){
     new_job = ExtractJob(&(nodes[actual_node].queue));
     nodes[actual_node].servers[actual_server].serving_job = new_job;
     nodes[actual_node].queue_jobs--;
-    if(actual_node == payment_control){
+    if(gradient) start_derivative(&nodes[actual_node].totals[actual_server], routed_derivative, new_job, actual_node);
+    if(actual_node == priority_node){
       priority_classes[new_job->priority].queue_jobs--;
     }
 
@@ -394,10 +979,15 @@ void process_departure_priority(event **list, double current_time, node_stats *n
   }
   else{
     nodes[actual_node].servers[actual_server].status = idle;
+    ReleaseServer(&nodes[actual_node], actual_server);
   }
   
-  new_arr = GenerateEvent(job_arrival, SwitchNode(p, actual_node), actual_server, current_time);
-  InsertEvent(list, new_arr);
+  // with common random numbers the job itself moves to the next node, as an arrival processed right now
+  if(job_profiles) route_job(list, current_time, nodes, actual_node, actual_server);
+  else{
+    new_arr = GenerateEvent(job_arrival, SwitchNode(routes, actual_node, antithetic_replica), actual_server, current_time);
+    InsertEvent(list, new_arr);
+  }
 }
 
 void execute_replica(event **list, node_stats *nodes, time_integrated *areas) {
@@ -412,8 +1002,11 @@ void execute_replica(event **list, node_stats *nodes, time_integrated *areas) {
     actual_server = ev->server;
     next_time = ev->time;
 
+    // close the buckets of the day ended before this event
+    while(next_time >= bucket_end) close_bucket(nodes, areas);
+
     // update integrals for every node
-    for(int node=0; node<NODES; node++){ 
+    for(int node=0; node<nodes_num; node++){ 
       areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
       areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
     }
@@ -442,13 +1035,16 @@ void execute_replica_priority(event **list, node_stats *nodes, time_integrated *
     actual_server = ev->server;
     next_time = ev->time;
 
+    // close the buckets of the day ended before this event
+    while(next_time >= bucket_end) close_bucket(nodes, areas);
+
     // update integrals for every node
-    for(int node=0; node<NODES; node++){ 
+    for(int node=0; node<nodes_num; node++){ 
       areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
       areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
     }
     if(topology == improved){
-      for(int class=0; class<PRIORITY_CLASSES; class++){ 
+      for(int class=0; class<classes_num; class++){ 
         priority_areas[class].node_area += (next_time - current_time) * priority_classes[class].node_jobs;
         priority_areas[class].queue_area += (next_time - current_time) * priority_classes[class].queue_jobs;
       }
@@ -474,8 +1070,8 @@ void execute_batch(event **list, node_stats *nodes, time_integrated *areas, int
   node_id actual_node;
   int actual_server;
   double next_time;
-  // spawn new event until we achieve b jobs in the batch
-  while (external_arrivals < (b * (k + 1))){
+  // spawn new event until we achieve b jobs in the batch or the horizon is reached
+  while (*list != NULL && external_arrivals < (b * (k + 1))){
     // extract next event
     ev = ExtractEvent(list);
     actual_node = ev->node;
@@ -483,7 +1079,7 @@ void execute_batch(event **list, node_stats *nodes, time_integrated *areas, int
     next_time = ev->time;
 
     // update integrals for every node
-    for(int node=0; node<NODES; node++){ 
+    for(int node=0; node<nodes_num; node++){ 
       areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
       areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
     }
@@ -504,8 +1100,8 @@ void execute_batch_priority(event **list, node_stats *nodes, time_integrated *ar
   node_id actual_node;
   int actual_server;
   double next_time;
-  // spawn new event until we achieve b jobs in the batch
-  while (external_arrivals < (b * (k + 1))){
+  // spawn new event until we achieve b jobs in the batch or the horizon is reached
+  while (*list != NULL && external_arrivals < (b * (k + 1))){
     // extract next event
     ev = ExtractEvent(list);
     actual_node = ev->node;
@@ -513,11 +1109,11 @@ void execute_batch_priority(event **list, node_stats *nodes, time_integrated *ar
     next_time = ev->time;
 
     // update integrals for every node
-    for(int node=0; node<NODES; node++){ 
+    for(int node=0; node<nodes_num; node++){ 
       areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
       areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
     }
-    for(int class=0; class<PRIORITY_CLASSES; class++){ 
+    for(int class=0; class<classes_num; class++){ 
       priority_areas[class].node_area += (next_time - current_time) * priority_classes[class].node_jobs;
       priority_areas[class].queue_area += (next_time - current_time) * priority_classes[class].queue_jobs;
     }
@@ -537,54 +1133,1476 @@ void execute_batch_priority(event **list, node_stats *nodes, time_integrated *ar
   }
 }
 
-void init_event_list(event **list){
-  event *new_arrival;
+long execute_warmup(event **list, node_stats *nodes, time_integrated *areas){
+  analysis **observation;
+  mser_state mser;
+  long obs_num, truncation, start_streams[RNG_STREAMS];
+
+  // the detection starts from saved streams, so that the run can be repeated up to the truncation point
+  while(*list != NULL) free(ExtractEvent(list));
+  external_arrivals = 0;
+  save_streams(start_streams);
+  init_event_list(list);
+
+  // every observation is the mean response time of WARMUP_OBS_SIZE jobs
+  init_result(&observation, 1);
+  init_mser(&mser, WARMUP_MAX_OBS);
+  for(obs_num=0; obs_num<WARMUP_MAX_OBS && !mser_stable(&mser); obs_num++){
+    if(topology == improved){
+      execute_batch_priority(list, nodes, areas, WARMUP_OBS_SIZE, obs_num);
+      reset_priority_stats(priority_classes, priority_areas);
+    }
+    else execute_batch(list, nodes, areas, WARMUP_OBS_SIZE, obs_num);
+    extract_analysis(observation[0], nodes, areas, servers_num[topology], current_time - first_batch_arrival[0], first_batch_arrival);
+    reset_stats(nodes, areas, first_batch_arrival);
+    mser_update(&mser, get_response_time(observation[0]));
+  }
+  if(!mser_stable(&mser)){
+    printf("Warning: warm-up not detected within %d jobs, all of them are discarded\n", WARMUP_MAX_OBS * WARMUP_OBS_SIZE);
+    truncation = obs_num;
+  }
+  else truncation = mser.truncation;
+  free_mser(&mser);
+
+  // the run starts again from the same streams and only the first MSER-5 truncation observations are discarded:
+  // the observations after the truncation point are simulated again as the start of the first batch
+  if(truncation < obs_num){
+    while(*list != NULL) free(ExtractEvent(list));
+    clear_nodes(nodes, areas, nodes_num);
+    if(topology == improved) clear_nodes(priority_classes, priority_areas, classes_num);
+    current_time = START;
+    external_arrivals = 0;
+    restore_streams(start_streams);
+    init_event_list(list);
+    if(topology == improved){
+      execute_batch_priority(list, nodes, areas, truncation * WARMUP_OBS_SIZE, 0);
+      reset_priority_stats(priority_classes, priority_areas);
+    }
+    else execute_batch(list, nodes, areas, truncation * WARMUP_OBS_SIZE, 0);
+    reset_stats(nodes, areas, first_batch_arrival);
+  }
 
-  for(int node=0; node<NODES; node++){
-    if(lambda[node] != 0){
-      new_arrival = GenerateEvent(job_arrival, node, outside, START + GetInterArrival(node));
-      if(new_arrival->time < stop_time && external_arrivals < max_processable_jobs){
-        InsertEvent(list, new_arrival);
-        external_arrivals++;
+  // batches start counting jobs from the end of the warm-up
+  external_arrivals = 0;
+  return truncation * WARMUP_OBS_SIZE;
+}
+
+int execute_adaptive_batches(event **list, node_stats *nodes, time_integrated *areas, analysis **result, analysis **priority_result){
+  int b = batch_size;
+  long k = 0;
+  double batch_period;
+
+  // memory is fixed to iter_num batches: when the test fails adjacent batches are merged and the size doubles
+  while(1){
+    batch_period = b / external_rate(lambda[topology]);
+    for(; k<iter_num; k++){
+      if(topology == improved){
+        execute_batch_priority(list, nodes, areas, b, k);
+        extract_analysis(result[k], nodes, areas, servers_num[topology], batch_period, first_batch_arrival);
+        extract_priority_analysis(priority_result[k], priority_classes, priority_areas, servers_num[topology][payment_control], batch_period, first_batch_arrival);
+        reset_priority_stats(priority_classes, priority_areas);
+      }
+      else{
+        execute_batch(list, nodes, areas, b, k);
+        extract_analysis(result[k], nodes, areas, servers_num[topology], batch_period, first_batch_arrival);
+      }
+      reset_stats(nodes, areas, first_batch_arrival);
+    }
+    loading_bar(log2((double) b / ADAPTIVE_MIN_BATCH_SIZE + 1) / log2((double) ADAPTIVE_MAX_BATCH_SIZE / ADAPTIVE_MIN_BATCH_SIZE + 1));
+
+    if(batches_uncorrelated(result, iter_num)) break;
+    if(2 * b > ADAPTIVE_MAX_BATCH_SIZE){
+      loading_bar(1.0);
+      printf("Warning: batch means still correlated with the max batch size of %d jobs\n", b);
+      return b;
+    }
+
+    // batch k of size 2b covers the same jobs of batches 2k and 2k+1 of size b
+    for(k=0; k<iter_num/2; k++){
+      for(int i=0; i<nodes_num; i++) merge_analysis(&result[k][i], &result[2*k][i], &result[2*k+1][i], servers_num[topology][i]);
+      if(topology == improved){
+        for(int i=0; i<PRIORITY_CLASSES; i++) merge_analysis(&priority_result[k][i], &priority_result[2*k][i], &priority_result[2*k+1][i], servers_num[topology][payment_control]);
       }
     }
+    b *= 2;
   }
+  loading_bar(1.0);
+
+  return b;
 }
 
-void init_servers(server_stats **servers, int servers_n){
-  *servers = calloc(servers_n, sizeof(server_stats));
-  if(*servers == NULL){
-    printf("Error allocating memory for: server_stats\n");
-    exit(1);
+void execute_batch_intervals(event **list, node_stats *nodes, time_integrated *areas, int k, interval_stream *stream){
+  int intervals = batch_size / VARIANCE_INTERVAL_SIZE;
+
+  // the batch is executed one interval at a time, recording the partial sums of every interval
+  for(int j=0; j<intervals; j++){
+    if(topology == improved) execute_batch_priority(list, nodes, areas, VARIANCE_INTERVAL_SIZE, k*intervals + j);
+    else execute_batch(list, nodes, areas, VARIANCE_INTERVAL_SIZE, k*intervals + j);
+    record_interval(stream, nodes, areas, current_time);
   }
+  reset_interval_snapshot(stream);
 }
 
-void init_nodes(node_stats **nodes){
-  *nodes = calloc(NODES, sizeof(node_stats));
-  if(*nodes == NULL){
-    printf("Error allocating memory for: nodes_stats\n");
-    exit(2);
+void execute_regenerative(event **list, node_stats *nodes, time_integrated *areas, interval_stream *stream){
+  event *ev;
+  node_id actual_node;
+  int actual_server;
+  double next_time;
+  long arrivals = 0, (*histogram)[REGENERATIVE_MAX_STATE] = calloc(NODES, sizeof(*histogram));
+  int state[NODES] = {0};
+  int regenerated = 0, match;
+
+  if(histogram == NULL){
+    printf("Error allocating memory for: regeneration histogram\n");
+    exit(6);
+  }
+  while(*list != NULL){
+    // extract next event
+    ev = ExtractEvent(list);
+    actual_node = ev->node;
+    actual_server = ev->server;
+    next_time = ev->time;
+
+    // update integrals for every node
+    for(int node=0; node<nodes_num; node++){ 
+      areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
+      areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
+    }
+    current_time = next_time;
+
+    if(ev->type == job_arrival && actual_server == outside){
+      // the pilot phase selects the most frequent population of every node seen by external arrivals
+      if(arrivals < REGENERATIVE_PILOT_JOBS){
+        for(int node=0; node<nodes_num; node++) histogram[node][nodes[node].node_jobs < REGENERATIVE_MAX_STATE ? nodes[node].node_jobs : REGENERATIVE_MAX_STATE - 1]++;
+        if(++arrivals == REGENERATIVE_PILOT_JOBS){
+          for(int node=0; node<nodes_num; node++){
+            for(int n=1; n<REGENERATIVE_MAX_STATE; n++) if(histogram[node][n] > histogram[node][state[node]]) state[node] = n;
+          }
+        }
+      }
+      // with exponential times every visit of the selected state at an external arrival is a regeneration point
+      else{
+        match = 1;
+        for(int node=0; node<nodes_num; node++) match = match && nodes[node].node_jobs == state[node];
+        if(match){
+          if(regenerated) record_interval(stream, nodes, areas, current_time);
+          else{
+            // statistics start from the first regeneration, the pilot phase is discarded
+            reset_stats(nodes, areas, first_batch_arrival);
+            stream->last_time = current_time;
+          }
+          regenerated = 1;
+        }
+      }
+    }
+
+    // process an arrival on a free server or in queue
+    if(ev->type == job_arrival) process_arrival(list, current_time, nodes, actual_node, actual_server);
+    
+    // process a departure from the specific busy server 
+    else process_departure(list, current_time, nodes, actual_node, actual_server);
+    
+    free(ev);
+  }
+  free(histogram);
+}
+
+void route_job(event **list, double current_time, node_stats *nodes, int actual_node, int actual_server){
+  node_id destination = RouteNode(routes, actual_node, routed_job->profile->route[actual_node]);
+
+  if(trace.file != NULL && destination == payment_control) record_trace_arrival(&trace, current_time, routed_job->profile->service[payment_control], routed_job->profile->priority);
+  if(destination == outside) FreeJob(routed_job);
+  else if(topology == improved) process_arrival_priority(list, current_time, nodes, destination, actual_server);
+  else process_arrival(list, current_time, nodes, destination, actual_server);
+}
+
+void execute_topology(analysis **result){
+  event *event_list = NULL;
+  node_stats *nodes;
+  time_integrated *areas;
+  double batch_period = BATCH_SIZE / external_rate(lambda[topology]);
+
+  // the jobs reaching payment_control don't depend on it: a topology that only changes payment_control replays them
+  if(incremental && lambda[topology][payment_control] == 0){
+    if(open_trace(&trace, trace_key(), iter_num)){
+      execute_replay(result, &trace);
+      close_trace(&trace);
+      return;
+    }
+    start_trace(&trace, trace_key(), iter_num);
+  }
+
+  // every topology restarts from the same seeds: jobs draw their own random numbers, so they are identical in all topologies
+  PlantSeeds(seed);
+  current_time = START;
+  for(int i=0; i<nodes_num; i++) first_batch_arrival[i] = START;
+
+  if(mode == finite_horizon){
+    for(int rep=0; rep<iter_num; rep++){
+      external_arrivals = 0;
+      init_event_list(&event_list);
+      init_nodes(&nodes);
+      init_areas(&areas);
+      if(topology == improved){
+        init_priority_nodes(&priority_classes, payment_control);
+        init_priority_areas(&priority_areas);
+        execute_replica_priority(&event_list, nodes, areas);
+      }
+      else execute_replica(&event_list, nodes, areas);
+      if(trace.file != NULL) record_trace_marker(&trace, rep, upstream_end_time(nodes), nodes, areas);
+      extract_analysis(result[rep], nodes, areas, servers_num[topology], current_time, NULL);
+      free(areas);
+      free(nodes);
+      if(!optimize) loading_bar((double)(topology * iter_num + rep + 1) / (COMPARED_TOPOLOGIES * iter_num));
+    }
+  }
+  else{
+    external_arrivals = 0;
+    init_event_list(&event_list);
+    init_nodes(&nodes);
+    init_areas(&areas);
+    if(topology == improved){
+      init_priority_nodes(&priority_classes, payment_control);
+      init_priority_areas(&priority_areas);
+    }
+    for(int k=0; k<iter_num; k++){
+      if(topology == improved){
+        execute_batch_priority(&event_list, nodes, areas, batch_size, k);
+        reset_priority_stats(priority_classes, priority_areas);
+      }
+      else execute_batch(&event_list, nodes, areas, batch_size, k);
+      if(trace.file != NULL) record_trace_marker(&trace, k, current_time, nodes, areas);
+      extract_analysis(result[k], nodes, areas, servers_num[topology], batch_period, first_batch_arrival);
+      reset_stats(nodes, areas, first_batch_arrival);
+      if(!optimize) loading_bar((double)(topology * iter_num + k + 1) / (COMPARED_TOPOLOGIES * iter_num));
+    }
   }
-  for(int i=0; i<NODES; i++){
-    (*nodes)[i].total_servers = servers_num[topology][i];
-    init_servers(&((*nodes)[i].servers), servers_num[topology][i]);
+  if(trace.file != NULL) finish_trace(&trace);
+}
+
+unsigned long long trace_key(void){
+  unsigned long long key = CACHE_HASH_BASIS;
+  int settings[] = {CACHE_VERSION, RNG_STREAMS, PROFILE_STREAM, NODES, PRIORITY_CLASSES, mode, seed, batch_size, iter_num};
+
+  // everything that changes the jobs reaching payment_control, nothing of payment_control itself
+  key = hash_bytes(key, settings, sizeof(settings));
+  key = hash_bytes(key, lambda[topology], NODES * sizeof(double));
+  key = hash_bytes(key, mu[topology], NODES * sizeof(double));
+  key = hash_bytes(key, servers_num[topology], payment_control * sizeof(int));
+  key = hash_bytes(key, queue_len[topology], payment_control * sizeof(unsigned long));
+  key = hash_bytes(key, routes, NODES * sizeof(route_table));
+  key = hash_bytes(key, priority_probs, sizeof(priority_probs));
+  key = hash_bytes(key, &stop_time, sizeof(stop_time));
+  key = hash_bytes(key, &max_processable_jobs, sizeof(max_processable_jobs));
+  return key;
+}
+
+double upstream_end_time(node_stats *nodes){
+  double end = START;
+
+  // the last event of the upstream nodes is a departure
+  for(int i=0; i<payment_control; i++){
+    for(int s=0; s<nodes[i].total_servers; s++) end = fmax(end, nodes[i].servers[s].last_departure_time);
   }
+  return end;
 }
 
-void init_priority_nodes(node_stats **nodes, node_id node){
-  *nodes = calloc(PRIORITY_CLASSES, sizeof(node_stats));
-  if(*nodes == NULL){
-    printf("Error allocating memory for: nodes_stats\n");
-    exit(2);
+void execute_replay(analysis **result, incremental_trace *trace){
+  event *event_list = NULL;
+  node_stats *nodes;
+  time_integrated *areas;
+  trace_arrival *arrival = trace->arrivals;
+  double batch_period = BATCH_SIZE / external_rate(lambda[topology]);
+
+  // no random numbers are drawn: payment_control receives the recorded jobs, the upstream nodes get the recorded statistics
+  current_time = START;
+  for(int i=0; i<nodes_num; i++) first_batch_arrival[i] = START;
+  for(long k=0; k<iter_num; k++){
+    if(k == 0 || mode == finite_horizon){
+      init_nodes(&nodes);
+      init_areas(&areas);
+      if(topology == improved){
+        init_priority_nodes(&priority_classes, payment_control);
+        init_priority_areas(&priority_areas);
+      }
+    }
+    for(; arrival->priority >= 0; arrival++){
+      replay_departures(&event_list, nodes, areas, arrival->time);
+      routed_job = GenerateTraceJob(arrival);
+      if(topology == improved) process_arrival_priority(&event_list, current_time, nodes, payment_control, 0);
+      else process_arrival(&event_list, current_time, nodes, payment_control, 0);
+    }
+
+    // the marker closes the batch at the recorded time, or the replica when both the upstream nodes and payment_control are over
+    if(mode == finite_horizon){
+      replay_departures(&event_list, nodes, areas, INFINITY);
+      current_time = fmax(current_time, arrival->time);
+    }
+    else replay_departures(&event_list, nodes, areas, arrival->time);
+    arrival++;
+    restore_upstream(trace, k, nodes, areas);
+    if(mode == finite_horizon){
+      extract_analysis(result[k], nodes, areas, servers_num[topology], current_time, NULL);
+      free(areas);
+      free(nodes);
+    }
+    else{
+      if(topology == improved) reset_priority_stats(priority_classes, priority_areas);
+      extract_analysis(result[k], nodes, areas, servers_num[topology], batch_period, first_batch_arrival);
+      reset_stats(nodes, areas, first_batch_arrival);
+    }
+    if(!optimize) loading_bar((double)(topology * iter_num + k + 1) / (COMPARED_TOPOLOGIES * iter_num));
+  }
+}
+
+void replay_departures(event **list, node_stats *nodes, time_integrated *areas, double limit){
+  event *ev;
+
+  // departures from payment_control before the limit, then the integrals move up to the limit
+  while(*list != NULL && (*list)->time < limit){
+    ev = ExtractEvent(list);
+    advance_replay(nodes, areas, ev->time);
+    if(topology == improved) process_departure_priority(list, current_time, nodes, ev->node, ev->server);
+    else process_departure(list, current_time, nodes, ev->node, ev->server);
+    free(ev);
   }
-  for(int i=0; i<PRIORITY_CLASSES; i++){
-    (*nodes)[i].total_servers = servers_num[improved][node];
-    init_servers(&((*nodes)[i].servers), servers_num[improved][node]);
+  if(limit < INFINITY) advance_replay(nodes, areas, limit);
+}
+
+void advance_replay(node_stats *nodes, time_integrated *areas, double next_time){
+  // only payment_control has jobs in the replay
+  areas[payment_control].node_area += (next_time - current_time) * nodes[payment_control].node_jobs;
+  areas[payment_control].queue_area += (next_time - current_time) * nodes[payment_control].queue_jobs;
+  if(topology == improved){
+    for(int class=0; class<classes_num; class++){
+      priority_areas[class].node_area += (next_time - current_time) * priority_classes[class].node_jobs;
+      priority_areas[class].queue_area += (next_time - current_time) * priority_classes[class].queue_jobs;
+    }
+  }
+  current_time = next_time;
+}
+
+void execute_comparison(void){
+  analysis **compared[COMPARED_TOPOLOGIES], **difference;
+  statistic_analysis difference_result[COMPARED_TOPOLOGIES];
+  project_topology pairs[COMPARED_TOPOLOGIES][2] = {{resized, base}, {improved, base}, {improved, resized}};
+  char *names[COMPARED_TOPOLOGIES] = {"BASE", "RESIZED", "IMPROVED"};
+  char *first[COMPARED_TOPOLOGIES], *second[COMPARED_TOPOLOGIES];
+  lockstep_instance instances[COMPARED_TOPOLOGIES];
+
+  // simulate every topology on the same replicas/batches, in a single pass unless payment_control is replayed
+  for(int t=0; t<COMPARED_TOPOLOGIES; t++){
+    topology = t;
+    init_result(&compared[t], iter_num);
+    if(incremental) execute_topology(compared[t]);
+    memset(&instances[t], 0, sizeof(lockstep_instance));
+    instances[t].topology = t;
+    memcpy(instances[t].servers, servers_num[t], sizeof(instances[t].servers));
+    instances[t].result = compared[t];
+  }
+  if(!incremental) execute_lockstep(instances, COMPARED_TOPOLOGIES);
+
+  // paired differences remove the noise shared by the topologies
+  init_result(&difference, iter_num);
+  printf("Paired differences on %ld %s with common random numbers and %.2lf%% confidence ('*' = significant):\n\n", iter_num, mode == finite_horizon ? "simulations" : "batches", 100.0 * LOC);
+  for(int c=0; c<COMPARED_TOPOLOGIES; c++){
+    first[c] = names[pairs[c][0]];
+    second[c] = names[pairs[c][1]];
+    extract_paired_difference(compared[pairs[c][0]], compared[pairs[c][1]], difference, iter_num);
+    extract_statistic_analysis(difference, &difference_result[c], iter_num);
+    print_paired_difference(&difference_result[c], first[c], second[c]);
+  }
+  save_comparison_to_csv(difference_result, first, second, COMPARED_TOPOLOGIES, seed, mode);
+}
+
+void execute_lockstep(lockstep_instance *instances, int n){
+  event *input = NULL, *ev, *new_arr;
+  job *input_job;
+  int saved_servers[3][NODES];
+  project_topology generator = instances[0].topology;
+  double batch_period = BATCH_SIZE / external_rate(lambda[generator]);
+
+  // the input stream is drawn once with the seeds and the streams of execute_topology: every instance sees the jobs of its own run
+  for(int t=0; t<3; t++) memcpy(saved_servers[t], servers_num[t], sizeof(saved_servers[t]));
+  PlantSeeds(seed);
+  for(int i=0; i<n; i++){
+    instances[i].current_time = START;
+    for(int j=0; j<nodes_num; j++) instances[i].first_batch_arrival[j] = START;
+  }
+
+  for(long r=0; r<iter_num; r++){
+    topology = generator;
+    if(mode == finite_horizon || r == 0){
+      external_arrivals = 0;
+      init_event_list(&input);
+      for(int i=0; i<n; i++) init_instance(&instances[i]);
+    }
+
+    // every external arrival is fed to all the instances, until the end of the replica or of the batch
+    while(input != NULL && (mode == finite_horizon || external_arrivals < (unsigned long) (batch_size * (r + 1)))){
+      ev = ExtractEvent(&input);
+      topology = generator;
+      input_job = GenerateProfileJob(ev->time, ev->node, mu[topology], &class_table);
+      new_arr = GenerateEvent(job_arrival, ev->node, outside, ev->time + GetInterArrival(ev->node));
+      if(new_arr->time < stop_time && external_arrivals < max_processable_jobs){
+        InsertEvent(&input, new_arr);
+        external_arrivals++;
+      }
+      else free(new_arr);
+      for(int i=0; i<n; i++) feed_instance(&instances[i], ev, input_job);
+      FreeJob(input_job);
+      free(ev);
+    }
+
+    // a replica ends when every instance is empty, a batch after the arrival that completes it
+    for(int i=0; i<n; i++){
+      load_instance(&instances[i]);
+      if(mode == finite_horizon || input == NULL) advance_instance(&instances[i], INFINITY);
+      if(mode == finite_horizon){
+        extract_analysis(instances[i].result[r], instances[i].nodes, instances[i].areas, instances[i].servers, current_time, NULL);
+        free(instances[i].areas);
+        free(instances[i].nodes);
+      }
+      else{
+        if(topology == improved) reset_priority_stats(priority_classes, priority_areas);
+        extract_analysis(instances[i].result[r], instances[i].nodes, instances[i].areas, instances[i].servers, batch_period, instances[i].first_batch_arrival);
+        reset_stats(instances[i].nodes, instances[i].areas, instances[i].first_batch_arrival);
+      }
+      save_instance(&instances[i]);
+    }
+    if(!optimize) loading_bar((double)(r + 1) / iter_num);
+  }
+  topology = generator;
+  for(int t=0; t<3; t++) memcpy(servers_num[t], saved_servers[t], sizeof(saved_servers[t]));
+}
+
+void load_instance(lockstep_instance *instance){
+  topology = instance->topology;
+  current_time = instance->current_time;
+  priority_classes = instance->priority_nodes;
+  priority_areas = instance->priority_areas;
+}
+
+void save_instance(lockstep_instance *instance){
+  instance->current_time = current_time;
+}
+
+void init_instance(lockstep_instance *instance){
+  topology = instance->topology;
+  memcpy(servers_num[topology], instance->servers, sizeof(instance->servers));
+  instance->list = NULL;
+  init_nodes(&instance->nodes);
+  init_areas(&instance->areas);
+  if(topology == improved){
+    init_priority_nodes(&instance->priority_nodes, payment_control);
+    init_priority_areas(&instance->priority_areas);
+  }
+}
+
+void advance_instance(lockstep_instance *instance, double limit){
+  event *ev;
+  node_stats *nodes = instance->nodes;
+
+  // the same steps of execute_replica/execute_batch on the departures of the instance before the limit
+  while(instance->list != NULL && instance->list->time < limit){
+    ev = ExtractEvent(&instance->list);
+    integrate_instance(instance, ev->time);
+    if(topology == improved) process_departure_priority(&instance->list, current_time, nodes, ev->node, ev->server);
+    else process_departure(&instance->list, current_time, nodes, ev->node, ev->server);
+    free(ev);
+  }
+}
+
+void feed_instance(lockstep_instance *instance, event *arrival, job *input_job){
+  load_instance(instance);
+  advance_instance(instance, arrival->time);
+
+  // the external arrival itself, with a copy of the job drawn by the input stream
+  integrate_instance(instance, arrival->time);
+  routed_job = CopyProfileJob(input_job);
+  if(topology == improved) process_arrival_priority(&instance->list, current_time, instance->nodes, arrival->node, 0);
+  else process_arrival(&instance->list, current_time, instance->nodes, arrival->node, 0);
+  save_instance(instance);
+}
+
+void integrate_instance(lockstep_instance *instance, double next_time){
+  // update integrals for every node, as execute_replica/execute_batch do before every event
+  for(int node=0; node<nodes_num; node++){
+    instance->areas[node].node_area += (next_time - current_time) * instance->nodes[node].node_jobs;
+    instance->areas[node].queue_area += (next_time - current_time) * instance->nodes[node].queue_jobs;
+  }
+  if(topology == improved){
+    for(int class=0; class<classes_num; class++){
+      priority_areas[class].node_area += (next_time - current_time) * priority_classes[class].node_jobs;
+      priority_areas[class].queue_area += (next_time - current_time) * priority_classes[class].queue_jobs;
+    }
+  }
+  current_time = next_time;
+}
+
+void execute_optimizer(void){
+  server_candidate *explored, screening;
+  statistic_analysis exact;
+  int n = 0, current, step = 0, improved = 1, size, idx;
+  int servers[NODES], batch[NODES * NODES];
+  double rate[NODES];
+
+  explored = calloc(OPTIMIZER_MAX_CANDIDATES, sizeof(server_candidate));
+  if(explored == NULL){
+    printf("Error allocating memory for: server candidates\n");
+    exit(4);
+  }
+  traffic_equations(lambda[topology], routes, rate);
+
+  // start from the base servers, raised until every node with an infinite queue is stable
+  for(int k=0; k<nodes_num; k++){
+    servers[k] = servers_num[base][k];
+    while(queue_len[topology][k] == INFINITE_CAPACITY && rate[k] >= servers[k] * mu[topology][k]) servers[k]++;
+  }
+  current = add_candidate(explored, &n, servers, rate);
+  evaluate_candidates(explored, &current, 1);
+
+  // greedy marginal allocation: add the server that reduces the QoS violation the most
+  while(qos_violation(&explored[current]) > 0){
+    size = 0;
+    for(int k=0; k<nodes_num; k++){
+      memcpy(servers, explored[current].servers, sizeof(servers));
+      if(++servers[k] > OPTIMIZER_MAX_SERVERS) continue;
+      idx = add_candidate(explored, &n, servers, rate);
+      if(idx >= 0) batch[size++] = idx;
+    }
+    if(size == 0) break;
+    evaluate_candidates(explored, batch, size);
+    current = batch[0];
+    for(int i=1; i<size; i++) if(qos_violation(&explored[batch[i]]) < qos_violation(&explored[current])) current = batch[i];
+    loading_bar(fmin(0.5, 0.05 * ++step));
+  }
+
+  // local search: remove a server or move it to another node while the QoS is satisfied
+  while(improved && qos_violation(&explored[current]) == 0){
+    improved = 0;
+    size = 0;
+    for(int i=0; i<nodes_num; i++){
+      for(int j=0; j<nodes_num; j++){
+        memcpy(servers, explored[current].servers, sizeof(servers));
+        servers[i]--;
+        if(j != i) servers[j]++;
+        if(servers[i] < 1 || servers[j] > OPTIMIZER_MAX_SERVERS) continue;
+        idx = add_candidate(explored, &n, servers, rate);
+        if(idx < 0 || !explored[idx].stable || explored[idx].screened) continue;
+
+        // the analytic solution discards the moves that clearly violate the QoS before simulating them
+        if(!explored[idx].evaluated){
+          extract_analytic_analysis(lambda[topology], routes, mu[topology], servers, queue_len[topology], &exact);
+          memcpy(screening.ploss, exact.ploss[payment_control], sizeof(screening.ploss));
+          memcpy(screening.response, exact.avg_max_wait, sizeof(screening.response));
+          if(qos_violation(&screening) > OPTIMIZER_SCREEN_MARGIN){
+            explored[idx].screened = 1;
+            continue;
+          }
+        }
+        batch[size++] = idx;
+      }
+    }
+    evaluate_candidates(explored, batch, size);
+    for(int i=0; i<size; i++){
+      idx = batch[i];
+      if(qos_violation(&explored[idx]) > 0) continue;
+      if(explored[idx].cost < explored[current].cost || (explored[idx].cost == explored[current].cost && explored[idx].response[mean] < explored[current].response[mean])){
+        current = idx;
+        improved = 1;
+      }
+    }
+    loading_bar(fmin(0.95, 0.5 + 0.05 * ++step));
+  }
+  loading_bar(1.0);
+
+  // print output and save analysis to csv
+  pareto_front(explored, n);
+  print_optimizer_result(explored, n, &explored[current], servers_num[base], iter_num, mode);
+  save_optimizer_to_csv(explored, n, &explored[current], seed, mode);
+
+  // the close contenders of the cheapest configuration are ranked with more replicas/batches
+  if(selection && qos_violation(&explored[current]) == 0) execute_selection(explored, n, current);
+  free(explored);
+}
+
+int add_candidate(server_candidate *explored, int *n, int *servers, double *rate){
+  server_candidate *candidate;
+
+  for(int i=0; i<*n; i++){
+    if(memcmp(explored[i].servers, servers, sizeof(explored[i].servers)) == 0) return i;
+  }
+  if(*n == OPTIMIZER_MAX_CANDIDATES) return -1;
+
+  // unstable candidates are kept only to be reported as pruned
+  candidate = &explored[*n];
+  memcpy(candidate->servers, servers, sizeof(candidate->servers));
+  candidate->stable = 1;
+  for(int k=0; k<nodes_num; k++){
+    candidate->cost += servers[k];
+    if(queue_len[topology][k] == INFINITE_CAPACITY && rate[k] >= servers[k] * mu[topology][k]) candidate->stable = 0;
+  }
+  return (*n)++;
+}
+
+void evaluate_candidates(server_candidate *explored, int *batch, int size){
+  int fd[OPTIMIZER_WORKERS][2], pending[NODES * NODES], workers, count = 0, members;
+  server_candidate *group[NODES * NODES];
+  pid_t pid;
+
+  for(int i=0; i<size; i++){
+    if(!explored[batch[i]].evaluated && explored[batch[i]].stable) pending[count++] = batch[i];
+  }
+  if(count == 0) return;
+
+  // every worker process simulates a group of candidates in lockstep and sends them back through a pipe
+  workers = count < OPTIMIZER_WORKERS ? count : OPTIMIZER_WORKERS;
+  for(int w=0; w<workers; w++){
+    if(pipe(fd[w]) < 0){
+      printf("Error creating the pipe of an optimizer worker\n");
+      exit(5);
+    }
+    fflush(stdout);
+    pid = fork();
+    if(pid < 0){
+      printf("Error creating an optimizer worker\n");
+      exit(5);
+    }
+    if(pid == 0){
+      close(fd[w][0]);
+      members = 0;
+      for(int i=w; i<count; i+=workers) group[members++] = &explored[pending[i]];
+      simulate_candidates(group, members);
+      for(int i=0; i<members; i++){
+        if(write(fd[w][1], group[i], sizeof(server_candidate)) != sizeof(server_candidate)) _exit(1);
+      }
+      _exit(0);
+    }
+    close(fd[w][1]);
+  }
+  for(int w=0; w<workers; w++){
+    for(int i=w; i<count; i+=workers){
+      if(read(fd[w][0], &explored[pending[i]], sizeof(server_candidate)) != sizeof(server_candidate)){
+        printf("Error reading the result of an optimizer worker\n");
+        exit(5);
+      }
+    }
+    close(fd[w][0]);
+    wait(NULL);
+  }
+}
+
+void simulate_candidates(server_candidate **group, int n){
+  lockstep_instance instances[LOCKSTEP_MAX_INSTANCES];
+  statistic_analysis statistic_result;
+
+  // same seeds and job profiles for every candidate (see execute_topology), drawn once for the whole group
+  for(int i=0; i<n; i++){
+    memset(&instances[i], 0, sizeof(lockstep_instance));
+    instances[i].topology = topology;
+    memcpy(instances[i].servers, group[i]->servers, sizeof(instances[i].servers));
+    memcpy(servers_num[topology], group[i]->servers, sizeof(group[i]->servers));
+    init_result(&instances[i].result, iter_num);
+    if(incremental) execute_topology(instances[i].result);
+  }
+  if(!incremental) execute_lockstep(instances, n);
+
+  for(int i=0; i<n; i++){
+    extract_statistic_analysis(instances[i].result, &statistic_result, iter_num);
+    memcpy(group[i]->ploss, statistic_result.ploss[payment_control], sizeof(group[i]->ploss));
+    memcpy(group[i]->response, statistic_result.avg_max_wait, sizeof(group[i]->response));
+    group[i]->evaluated = 1;
+  }
+}
+
+void execute_selection(server_candidate *explored, int n, int best){
+  selection_system systems[SELECTION_MAX_SYSTEMS];
+  long eliminated[SELECTION_MAX_SYSTEMS] = {0}, r;
+  double *obs, S2[SELECTION_MAX_SYSTEMS * SELECTION_MAX_SYSTEMS], h2;
+  int k = 0, alive, selected = -1;
+
+  // shortlist: same cost of the best configuration, ploss satisfied and response time close to the QoS
+  for(int i=0; i<n && k<SELECTION_MAX_SYSTEMS; i++){
+    if(!explored[i].evaluated || explored[i].cost != explored[best].cost) continue;
+    if(explored[i].ploss[mean] >= QOS_MAX_PLOSS || explored[i].response[mean] >= QOS_MAX_RESPONSE * (1 + SELECTION_RESPONSE_MARGIN)) continue;
+    memset(&systems[k], 0, sizeof(selection_system));
+    systems[k].candidate = &explored[i];
+    k++;
+  }
+  if(k < 2){
+    printf("Ranking and selection: no close contender of the cheapest configuration\n\n");
+    return;
+  }
+
+  obs = calloc(k * SELECTION_MAX_OBS, sizeof(double));
+  if(obs == NULL){
+    printf("Error allocating memory: ranking and selection\n");
+    exit(5);
+  }
+
+  // every system starts from the same seeds, as in execute_topology
+  PlantSeeds(seed);
+  for(int i=0; i<k; i++){
+    save_streams(systems[i].streams);
+    systems[i].current_time = START;
+    for(int j=0; j<nodes_num; j++) systems[i].first_batch_arrival[j] = START;
+  }
+  if(mode == infinite_horizon) stop_time = INFINITE_HORIZON_STOP * SELECTION_MAX_OBS / BATCH_NUM;
+
+  printf("Ranking and selection in progress, please wait\n");
+  loading_bar(0.0);
+
+  // first stage: the same number of observations for every system gives the variances of the differences
+  h2 = kn_parameter(k, SELECTION_INITIAL_OBS, SELECTION_PCS);
+  for(r=0; r<SELECTION_INITIAL_OBS; r++){
+    for(int i=0; i<k; i++) obs[i*SELECTION_MAX_OBS + r] = observe_system(&systems[i]);
+  }
+  kn_variances(obs, SELECTION_MAX_OBS, k, SELECTION_INITIAL_OBS, S2);
+
+  // sequential stages: one more observation only for the systems not eliminated yet
+  alive = kn_screen(obs, SELECTION_MAX_OBS, k, r, S2, h2, SELECTION_INDIFFERENCE, eliminated);
+  while(alive > 1 && r < SELECTION_MAX_OBS){
+    for(int i=0; i<k; i++){
+      if(!eliminated[i]) obs[i*SELECTION_MAX_OBS + r] = observe_system(&systems[i]);
+    }
+    r++;
+    alive = kn_screen(obs, SELECTION_MAX_OBS, k, r, S2, h2, SELECTION_INDIFFERENCE, eliminated);
+    loading_bar((double)r / SELECTION_MAX_OBS);
+  }
+  loading_bar(1.0);
+
+  // the best surviving system is selected (more than one only if the observation budget ran out)
+  for(int i=0; i<k; i++){
+    systems[i].eliminated = eliminated[i];
+    systems[i].response = 0;
+    for(long j=0; j<systems[i].observations; j++) systems[i].response += obs[i*SELECTION_MAX_OBS + j] / systems[i].observations;
+    if(!eliminated[i] && (selected < 0 || systems[i].response < systems[selected].response)) selected = i;
+  }
+  print_selection_result(systems, k, selected, alive == 1);
+  save_selection_to_csv(systems, k, selected, alive == 1, seed, mode);
+  free(obs);
+}
+
+double observe_system(selection_system *system){
+  analysis **result;
+  double response;
+
+  // restore the run of the system: its own streams, clock and (infinite horizon) event list
+  memcpy(servers_num[topology], system->candidate->servers, sizeof(system->candidate->servers));
+  restore_streams(system->streams);
+  current_time = system->current_time;
+  external_arrivals = system->external_arrivals;
+  memcpy(first_batch_arrival, system->first_batch_arrival, sizeof(first_batch_arrival));
+  init_result(&result, 1);
+
+  if(mode == finite_horizon){
+    external_arrivals = 0;
+    init_event_list(&system->list);
+    init_nodes(&system->nodes);
+    init_areas(&system->areas);
+    execute_replica(&system->list, system->nodes, system->areas);
+    extract_analysis(result[0], system->nodes, system->areas, servers_num[topology], current_time, NULL);
+    free(system->areas);
+    free(system->nodes);
+  }
+  else{
+    if(system->observations == 0){
+      init_event_list(&system->list);
+      init_nodes(&system->nodes);
+      init_areas(&system->areas);
+    }
+    execute_batch(&system->list, system->nodes, system->areas, batch_size, system->observations);
+    extract_analysis(result[0], system->nodes, system->areas, servers_num[topology], BATCH_SIZE / external_rate(lambda[topology]), first_batch_arrival);
+    reset_stats(system->nodes, system->areas, first_batch_arrival);
+  }
+  response = get_response_time(result[0]);
+
+  // save the run of the system for its next observation
+  save_streams(system->streams);
+  system->current_time = current_time;
+  system->external_arrivals = external_arrivals;
+  memcpy(system->first_batch_arrival, first_batch_arrival, sizeof(first_batch_arrival));
+  system->observations++;
+  for(int i=0; i<nodes_num; i++){
+    free(result[0][i].server_utilization);
+    free(result[0][i].server_service);
+    free(result[0][i].server_share);
+  }
+  free(result[0]);
+  free(result);
+
+  return response;
+}
+
+void execute_analytic(void){
+  statistic_analysis analytic_result, priority_analytic_result, cobham_result;
+  ctmc_analysis ctmc;
+  clock_t start;
+
+  // steady state of every node from the traffic equations, in the same form of the simulation output
+  extract_analytic_analysis(lambda[topology], routes, mu[topology], servers_num[topology], queue_len[topology], &analytic_result);
+  if(topology == improved){
+    // the priority classes come from the CTMC of payment_control, checked with Cobham's formula if the queue is infinite
+    start = clock();
+    extract_ctmc_priority_analysis(&analytic_result, payment_control, mu[topology][payment_control], servers_num[topology][payment_control], queue_len[topology][payment_control], priority_probs, &priority_analytic_result, &ctmc);
+    print_improved_statistic_result(&analytic_result, &priority_analytic_result, priority_probs, mode);
+    save_improved_to_csv(&analytic_result, &priority_analytic_result, topology, seed, mode);
+    if(ctmc.truncated) extract_analytic_priority_analysis(&analytic_result, payment_control, mu[topology][payment_control], servers_num[topology][payment_control], priority_probs, &cobham_result);
+    print_ctmc_analysis(&ctmc, 1000.0 * (clock() - start) / CLOCKS_PER_SEC, &priority_analytic_result, ctmc.truncated ? &cobham_result : NULL);
+  }
+  else{
+    print_statistic_result(&analytic_result, mode);
+    save_to_csv(&analytic_result, topology, seed, mode);
+  }
+}
+
+/**
+* Benchmark of the engine on random meshes from MESH_MIN_NODES to MESH_MAX_NODES nodes (or a single size)
+**/
+void execute_mesh_benchmark(void){
+  mesh_network network;
+  mesh_benchmark *results;
+  int sizes = 0;
+
+  for(int n=MESH_MIN_NODES; n<=MESH_MAX_NODES; n*=10) sizes++;
+  if(mesh_nodes > 0) sizes = 1;
+  results = calloc(sizes, sizeof(mesh_benchmark));
+  if(results == NULL){
+    printf("Error allocating memory: mesh benchmark\n");
+    exit(5);
+  }
+
+  // every size gets the same external traffic, so the events per job only depend on the routing
+  printf("Mesh benchmark in progress, please wait\n");
+  loading_bar(0.0);
+  for(int i=0, n=(mesh_nodes > 0 ? mesh_nodes : MESH_MIN_NODES); i<sizes; i++, n*=10){
+    PlantSeeds(seed);
+    generate_mesh(&network, n, mesh_classes);
+    execute_mesh(&network, &results[i]);
+    free_mesh(&network);
+    loading_bar((double) (i + 1) / sizes);
+  }
+
+  print_mesh_benchmark(results, sizes);
+  save_mesh_benchmark_to_csv(results, sizes, seed);
+  free(results);
+}
+
+/**
+* Simulate MESH_BENCHMARK_JOBS external arrivals on a mesh with the engine of the improved topology, until the mesh is empty.
+* The parameters of the improved topology point to the ones of the mesh and its busiest node takes the priority classes
+**/
+void execute_mesh(mesh_network *network, mesh_benchmark *result){
+  event *event_list = NULL, *ev;
+  node_stats *nodes;
+  node_id node;
+  long jobs, queued, population = 0, busy = 0, peak = 0, peak_busy = 0, processed = 0, rejected = 0, servers = 0;
+  double area = 0;
+  clock_t start;
+
+  nodes_num = network->nodes;
+  classes_num = network->classes;
+  lambda[improved] = network->lambda;
+  mu[improved] = network->mu;
+  servers_num[improved] = network->servers;
+  queue_len[improved] = network->queue;
+  routes = network->routes;
+  priority_node = network->busiest;
+  init_priority_table(&class_table, classes_num, network->class_prob);
+  current_time = START;
+  stop_time = INFINITY;
+  external_arrivals = 0;
+  max_processable_jobs = MESH_BENCHMARK_JOBS;
+
+  memset(result, 0, sizeof(mesh_benchmark));
+  start = clock();
+  init_nodes(&nodes);
+  init_priority_nodes(&priority_classes, priority_node);
+  init_event_list(&event_list);
+  while(event_list != NULL){
+    ev = ExtractEvent(&event_list);
+    node = ev->node;
+    jobs = nodes[node].node_jobs;
+    queued = nodes[node].queue_jobs;
+
+    // only the node of the event changes, so the population of the mesh is integrated without a scan of the nodes
+    area += (ev->time - current_time) * population;
+    current_time = ev->time;
+    if(ev->type == job_arrival) process_arrival_priority(&event_list, current_time, nodes, node, ev->server);
+    else process_departure_priority(&event_list, current_time, nodes, node, ev->server);
+    population += nodes[node].node_jobs - jobs;
+    busy += nodes[node].node_jobs - nodes[node].queue_jobs - (jobs - queued);
+    if(population > peak){
+      peak = population;
+      peak_busy = busy;
+    }
+    result->events++;
+    free(ev);
+  }
+  result->seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+  for(int i=0; i<nodes_num; i++){
+    processed += nodes[i].processed_jobs;
+    rejected += nodes[i].rejected_jobs;
+    servers += nodes[i].total_servers;
+  }
+  result->nodes = network->nodes;
+  result->edges = network->edges;
+  result->classes = network->classes;
+  result->population = area / (current_time - START);
+  result->wait = processed > 0 ? area / processed : 0;
+  result->ploss = (double) rejected / (processed + rejected);
+
+  // parameters, routing, node and server state, then the class table and the class-wise state of the priority node
+  result->state_bytes = nodes_num * (2 * sizeof(double) + sizeof(int) + sizeof(unsigned long) + sizeof(route_table) + sizeof(node_stats));
+  result->state_bytes += servers * (sizeof(server_stats) + sizeof(server_totals));
+  result->state_bytes += classes_num * (3 * sizeof(double) + sizeof(int) + sizeof(node_stats) + servers_num[improved][priority_node] * (sizeof(server_stats) + sizeof(server_totals)));
+  // at the peak population the jobs are allocated, with the departures of the busy servers and an arrival of every entry pending
+  result->peak_bytes = result->state_bytes + peak * sizeof(job) + (peak_busy + network->entries) * sizeof(event);
+  result->state_bytes /= nodes_num;
+  result->peak_bytes /= nodes_num;
+
+  free(nodes[0].servers);
+  free(nodes[0].totals);
+  free(nodes);
+  free(priority_classes[0].servers);
+  free(priority_classes[0].totals);
+  free(priority_classes);
+  free_priority_table(&class_table);
+}
+
+void apply_arrival_log(char *filename){
+  open_arrival_log(&request_log, filename);
+
+  // the rates of the log replace lambda: they set the batch periods and the analytic solution used by --validate
+  for(int i=0; i<COMPILED_NODES; i++) lambda[topology][i] = request_log.header.entries[i] / log_cycle(&request_log);
+  printf("Replaying %ld requests over %.2lf s from %s (%.4lf requests/s)\n", request_log.header.requests, request_log.header.span, filename, external_rate(lambda[topology]));
+}
+
+void apply_model(char *filename){
+  topology_model model;
+
+  model.nodes = nodes_num;
+  memcpy(model.lambda, lambda[topology], sizeof(model.lambda));
+  memcpy(model.mu, mu[topology], sizeof(model.mu));
+  memcpy(model.servers, servers_num[topology], sizeof(model.servers));
+  memcpy(model.queue, queue_len[topology], sizeof(model.queue));
+  memcpy(model.routes, routes, sizeof(model.routes));
+  memset(model.rates, 0, sizeof(model.rates));
+  load_model(&model, filename);
+  nodes_num = model.nodes;
+  memcpy(lambda[topology], model.lambda, sizeof(model.lambda));
+  memcpy(mu[topology], model.mu, sizeof(model.mu));
+  memcpy(servers_num[topology], model.servers, sizeof(model.servers));
+  memcpy(queue_len[topology], model.queue, sizeof(model.queue));
+  memcpy(routes, model.routes, sizeof(model.routes));
+  memcpy(rates, model.rates, sizeof(model.rates));
+  for(int i=0; i<nodes_num; i++) time_varying |= rates[i].points > 0;
+}
+
+void report_validation(statistic_analysis *statistic_result, statistic_analysis *priority_statistic_result){
+  statistic_analysis exact, priority_exact;
+  ctmc_analysis ctmc;
+
+  extract_analytic_analysis(lambda[topology], routes, mu[topology], servers_num[topology], queue_len[topology], &exact);
+  print_validation(statistic_result, &exact);
+  if(priority_statistic_result != NULL){
+    extract_ctmc_priority_analysis(&exact, payment_control, mu[topology][payment_control], servers_num[topology][payment_control], queue_len[topology][payment_control], priority_probs, &priority_exact, &ctmc);
+    print_priority_validation(priority_statistic_result, &priority_exact);
+  }
+}
+
+unsigned long long cache_key(void){
+  unsigned long long key = CACHE_HASH_BASIS;
+  int settings[] = {CACHE_VERSION, RNG_STREAMS, nodes_num, PRIORITY_CLASSES, sizeof(analysis), topology, mode, seed, batch_size, warmup};
+
+  // everything that changes the sequence of replicas/batches, not the number of them or the post-processing
+  key = hash_bytes(key, settings, sizeof(settings));
+  key = hash_bytes(key, lambda[topology], NODES * sizeof(double));
+  key = hash_bytes(key, mu[topology], NODES * sizeof(double));
+  key = hash_bytes(key, servers_num[topology], NODES * sizeof(int));
+  key = hash_bytes(key, queue_len[topology], NODES * sizeof(unsigned long));
+  key = hash_bytes(key, routes, NODES * sizeof(route_table));
+  key = hash_bytes(key, priority_probs, sizeof(priority_probs));
+  key = hash_bytes(key, &horizon, sizeof(horizon));         // --precision only extends the run
+  key = hash_bytes(key, &max_processable_jobs, sizeof(max_processable_jobs));
+  return key;
+}
+
+void init_cache_state(cache_state *state, event **list, node_stats *nodes, time_integrated *areas){
+  state->list = list;
+  state->nodes = nodes;
+  state->areas = areas;
+  state->priority_nodes = priority_classes;
+  state->priority_areas = priority_areas;
+  state->current_time = &current_time;
+  state->first_arrival = first_batch_arrival;
+  state->external_arrivals = &external_arrivals;
+}
+
+long load_cache(result_cache *cache, analysis **result, analysis **priority_result, cache_state *state, long *discarded, double *progress){
+  statistic_analysis statistic_result, priority_statistic_result;
+  long cached, executed = 0;
+
+  *progress = 0;
+  if(!cache->enabled) return 0;
+  cached = read_cached_records(cache, result, priority_result, iter_num, servers_num[topology], servers_num[improved][payment_control]);
+  if(cached < fmin(cache->header.records, iter_num)) cache->header.records = 0;    // unreadable cache, overwritten by this run
+
+  // the cached records go through the same stopping rule as the simulated ones
+  while(executed < cached && *progress < 1){
+    executed++;
+    *progress = (double)executed/iter_num;
+    if(precision > 0 && executed >= SEQUENTIAL_MIN_ITER){
+      *progress = fmax(*progress, check_precision(result, priority_result, executed, &statistic_result, &priority_statistic_result));
+    }
+  }
+  if(executed == 0) return 0;
+
+  // the run continues from the state after the last cached record only if it needs more records
+  *discarded = cache->header.discarded;
+  if(executed == cache->header.records && executed < iter_num && *progress < 1){
+    read_cached_state(cache, servers_num[topology], servers_num[improved][payment_control], state);
+  }
+  loading_bar(fmin(*progress, 1.0));
+  return executed;
+}
+
+void store_cache(result_cache *cache, analysis **result, analysis **priority_result, long n, cache_state *state, long discarded, long reused){
+  if(!cache->enabled) return;
+  if(reused > 0) print_cache_usage(reused, n, cache->filename);
+  if(n <= cache->header.records) return;
+  cache->header.discarded = discarded;
+  write_cache(cache, result, priority_result, n, servers_num[topology], servers_num[improved][payment_control], state);
+}
+
+void prepare_antithetic_replica(int rep){
+  // the first replica of a pair continues the streams, the second one repeats them with 1 - U
+  if(rep % 2 == 0){
+    if(rep > 0) restore_streams(pair_seeds[1]);
+    save_streams(pair_seeds[0]);
+    antithetic_replica = 0;
+  }
+  else{
+    save_streams(pair_seeds[1]);
+    restore_streams(pair_seeds[0]);
+    antithetic_replica = 1;
+  }
+}
+
+long merge_antithetic_pairs(analysis **result, analysis **priority_result, long n){
+  // the average of a pair replaces the pair, an unpaired last replica is dropped
+  for(long j=0; j<n/2; j++){
+    for(int i=0; i<nodes_num; i++) merge_analysis(&result[j][i], &result[2*j][i], &result[2*j+1][i], servers_num[topology][i]);
+    if(priority_result != NULL){
+      for(int i=0; i<PRIORITY_CLASSES; i++) merge_analysis(&priority_result[j][i], &priority_result[2*j][i], &priority_result[2*j+1][i], servers_num[topology][payment_control]);
+    }
+  }
+  antithetic_replica = 0;
+  return n/2;
+}
+
+void report_control_variates(analysis **result, long n, statistic_analysis *statistic_result){
+  double rate[NODES], expected_interarrival[NODES], expected_service[NODES];
+  control_variate_analysis cv_result;
+
+  // expected values are known from the model: traffic equations for the arrivals, mu for the services
+  traffic_equations(lambda[topology], routes, rate);
+  for(int i=0; i<nodes_num; i++){
+    expected_interarrival[i] = 1.0 / rate[i];
+    expected_service[i] = 1.0 / mu[topology][i];
+  }
+  extract_control_variate_analysis(result, n, expected_interarrival, expected_service, &cv_result);
+  print_control_variate_analysis(statistic_result, &cv_result);
+  save_control_variate_to_csv(&cv_result, topology, seed, mode);
+}
+
+/**
+* Start the buckets of the day at the beginning of a replica
+**/
+void init_buckets(void){
+  memset(&bucket_start, 0, sizeof(bucket_start));
+  entered_jobs = 0;
+  bucket_index = 0;
+  bucket_end = START + RATE_PERIOD / RATE_BUCKETS;
+}
+
+/**
+* Integrate the replica up to the end of the current bucket and add its metrics to the bucket, the event loop goes on from there
+**/
+void close_bucket(node_stats *nodes, time_integrated *areas){
+  double width = RATE_PERIOD / RATE_BUCKETS, area, value[BUCKET_METRICS], diff;
+  long processed, rejected;
+  time_bucket *bucket = &buckets[bucket_index];
+
+  for(int node=0; node<nodes_num; node++){
+    areas[node].node_area += (bucket_end - current_time) * nodes[node].node_jobs;
+    areas[node].queue_area += (bucket_end - current_time) * nodes[node].queue_jobs;
+  }
+  if(topology == improved){
+    for(int class=0; class<classes_num; class++){
+      priority_areas[class].node_area += (bucket_end - current_time) * priority_classes[class].node_jobs;
+      priority_areas[class].queue_area += (bucket_end - current_time) * priority_classes[class].queue_jobs;
+    }
+  }
+  current_time = bucket_end;
+
+  processed = nodes[payment_control].processed_jobs - bucket_start.processed[payment_control];
+  rejected = nodes[payment_control].rejected_jobs - bucket_start.rejected[payment_control];
+  value[bucket_arrivals] = (entered_jobs - bucket_start.entered) / width;
+  value[bucket_ploss] = (processed + rejected == 0) ? 0 : (double) rejected / (processed + rejected);
+  value[bucket_population] = 0;
+  value[bucket_response] = 0;
+
+  // waits of the bucket by Little's law on every node, a node without departures in the bucket adds nothing
+  for(int node=0; node<nodes_num; node++){
+    area = areas[node].node_area - bucket_start.node_area[node];
+    processed = nodes[node].processed_jobs - bucket_start.processed[node];
+    value[bucket_population] += area / width;
+    if(processed > 0) value[bucket_response] += area / processed;
+    bucket_start.node_area[node] = areas[node].node_area;
+    bucket_start.processed[node] = nodes[node].processed_jobs;
+    bucket_start.rejected[node] = nodes[node].rejected_jobs;
+  }
+  bucket_start.entered = entered_jobs;
+
+  bucket->samples++;
+  for(int m=0; m<BUCKET_METRICS; m++){
+    diff = value[m] - bucket->mean[m];
+    bucket->sum[m] += diff * diff * (bucket->samples - 1.0) / bucket->samples;
+    bucket->mean[m] += diff / bucket->samples;
+  }
+
+  if(++bucket_index == RATE_BUCKETS) bucket_end = INFINITY;
+  else bucket_end += width;
+}
+
+/**
+* Close the buckets left after the last event of the replica (the system is empty, only the counters move)
+**/
+void record_buckets(node_stats *nodes, time_integrated *areas){
+  double end_time = current_time;
+
+  while(bucket_index < RATE_BUCKETS) close_bucket(nodes, areas);
+  current_time = end_time;
+}
+
+void report_time_buckets(long n){
+  double width = RATE_PERIOD / RATE_BUCKETS;
+  long candidates = 0, rejected = 0;
+
+  // the expected rate of a bucket comes from the profiles, lambda for the nodes without one
+  for(int b=0; b<RATE_BUCKETS; b++){
+    buckets[b].expected = 0;
+    for(int k=0; k<nodes_num; k++){
+      if(rates[k].points > 0) buckets[b].expected += rates_integral(&rates[k], b * width, (b + 1) * width) / width;
+      else buckets[b].expected += lambda[topology][k];
+    }
+  }
+  for(int k=0; k<nodes_num; k++){
+    candidates += rates[k].candidates;
+    rejected += rates[k].rejected;
+  }
+  print_time_buckets(buckets, n, candidates, rejected);
+  save_time_buckets_to_csv(buckets, n, topology, seed);
+}
+
+void arrival_derivative(job *job, node_id node, int server){
+  // an external arrival moves with the interarrival times of its entry node, a routed one with the departure from the previous node
+  if(server == outside){
+    memset(job->derivative, 0, IPA_PARAMETERS * sizeof(double));
+    job->derivative[NODES + node] = external_derivative[node];
+  }
+  else memcpy(job->derivative, routed_derivative, sizeof(routed_derivative));
+}
+
+void start_derivative(server_totals *server, double *start, job *job, node_id node){
+  // the service S = -ln(1-u)/mu of the same random number u has dS/dmu = -S/mu
+  memcpy(server->departure_derivative, start, IPA_PARAMETERS * sizeof(double));
+  server->departure_derivative[node] -= job->service / mu[topology][node];
+}
+
+void depart_derivative(node_stats *node, int s){
+  job *serving_job = node->servers[s].serving_job;
+  double *arrival = serving_job->derivative, *departure = node->totals[s].departure_derivative;
+
+  for(int i=0; i<IPA_PARAMETERS; i++) node->wait_derivative[i] += departure[i] - arrival[i];
+  memcpy(routed_derivative, departure, sizeof(routed_derivative));
+}
+
+void record_gradient(gradient_sample *sample, node_stats *nodes){
+  for(int k=0; k<nodes_num; k++){
+    for(int i=0; i<IPA_PARAMETERS; i++) sample->wait[k][i] = nodes[k].processed_jobs > 0 ? nodes[k].wait_derivative[i] / nodes[k].processed_jobs : 0;
+  }
+}
+
+void report_gradients(gradient_sample *samples, long n){
+  gradient_analysis gradient_result;
+
+  extract_gradient_analysis(samples, n, &gradient_result);
+  // a full queue rejects a job, a priority class overtakes the others: the waits jump and IPA only sees the slopes
+  for(int k=0; k<nodes_num; k++) gradient_result.biased[k] = queue_len[topology][k] != INFINITE_CAPACITY || (topology == improved && k == payment_control);
+  // a larger lambda compresses the whole stream towards START: in steady state the merged streams drift apart
+  // with the simulated time and the derivatives grow with it, so only the mu ones are shown
+  gradient_result.lambda_omitted = mode == infinite_horizon;
+  gradient_result.exact = mode == infinite_horizon;
+  if(gradient_result.exact) analytic_gradient(&gradient_result);
+  print_gradient_analysis(&gradient_result, lambda[topology]);
+  save_gradient_to_csv(&gradient_result, lambda[topology], topology, seed, mode);
+}
+
+void analytic_gradient(gradient_analysis *result){
+  double rates[2][IPA_PARAMETERS], step;
+  statistic_analysis exact[2];
+
+  // central differences of the steady state of the traffic equations, a single parameter moved at a time
+  for(int i=0; i<IPA_PARAMETERS; i++){
+    for(int d=0; d<2; d++){
+      memcpy(rates[d], mu[topology], NODES * sizeof(double));
+      memcpy(rates[d] + NODES, lambda[topology], NODES * sizeof(double));
+      step = GRADIENT_STEP * rates[d][i];
+      rates[d][i] += d ? step : -step;
+      extract_analytic_analysis(rates[d] + NODES, routes, rates[d], servers_num[topology], queue_len[topology], &exact[d]);
+    }
+    for(int k=0; k<nodes_num; k++) result->exact_wait[k][i] = step > 0 ? (exact[1].wait[k][mean] - exact[0].wait[k][mean]) / (2 * step) : 0;
+    result->exact_avg_max_wait[i] = step > 0 ? (exact[1].avg_max_wait[mean] - exact[0].avg_max_wait[mean]) / (2 * step) : 0;
+  }
+}
+
+double rare_event_load(void){
+  double rate[NODES];
+
+  traffic_equations(lambda[topology], routes, rate);
+  return rate[payment_control] / (servers_num[topology][payment_control] * mu[topology][payment_control]);
+}
+
+void execute_rare_event(event **list, node_stats *nodes, time_integrated *areas, rare_event_analysis *result){
+  event *ev;
+  node_id actual_node;
+  int actual_server, c = servers_num[topology][payment_control], extra_pending = 0;
+  double next_time, rate[NODES], likelihood = 1, tilted_time = 0;
+  long cycles = 0, arrivals = 0, rejections = 0, rejected = 0, excursions = 0;
+  long excursion_rejections = 0, tilted_arrivals = 0, tilted_departures = 0;
+  int tilted_cycle = 0, all_busy;
+  statistic_analysis exact;
+
+  // the tilted cycles swap the arrival rate and the service capacity of payment_control (tilted load 1/rho) only while
+  // all its c servers are busy, until the first rejection of every excursion above c-1 jobs:
+  // the routed arrivals are kept and an extra Poisson stream adds the difference
+  memset(result, 0, sizeof(rare_event_analysis));
+  traffic_equations(lambda[topology], routes, rate);
+  result->rate = rate[payment_control];
+  result->mu = mu[topology][payment_control];
+  result->tilted_rate = c * result->mu;
+  result->tilted_mu = result->rate / c;
+  tilted_mu = result->tilted_mu;
+
+  // with Poisson arrivals payment_control is an M/M/c/K node, the reference of both estimators
+  memset(&exact, 0, sizeof(statistic_analysis));
+  analytic_node(result->rate, result->mu, c, queue_len[topology][payment_control], &exact, payment_control);
+  result->analytic = exact.ploss[payment_control][mean];
+
+  while(*list != NULL){
+    // extract next event
+    ev = ExtractEvent(list);
+    actual_node = ev->node;
+    actual_server = ev->server;
+    next_time = ev->time;
+
+    // update integrals for every node
+    for(int node=0; node<nodes_num; node++){ 
+      areas[node].node_area += (next_time - current_time) * nodes[node].node_jobs;
+      areas[node].queue_area += (next_time - current_time) * nodes[node].queue_jobs;
+    }
+    if(tilting) tilted_time += next_time - current_time;
+    current_time = next_time;
+
+    if(ev->type == job_arrival && actual_node == payment_control){
+      if(actual_server == RARE_EVENT_SOURCE) extra_pending = 0;
+      // an arrival to the empty payment_control closes the cycle, plain and tilted cycles alternate
+      if(nodes[payment_control].node_jobs == 0){
+        if(cycles > 0){
+          if(tilted_cycle) result->tilted_cycles++;
+          else record_plain_cycle(result, arrivals, rejections, excursions);
+        }
+        cycles++;
+        tilted_cycle = cycles % 2 == 0;
+        arrivals = 0;
+        rejections = 0;
+        excursions = 0;
+      }
+      arrivals++;
+      if(tilting) tilted_arrivals++;
+      rejected = nodes[payment_control].rejected_jobs;
+    }
+    else if(ev->type == job_departure && actual_node == payment_control && tilting) tilted_departures++;
+
+    // process an arrival on a free server or in queue
+    if(ev->type == job_arrival) process_arrival(list, current_time, nodes, actual_node, actual_server);
+    
+    // process a departure from the specific busy server 
+    else process_departure(list, current_time, nodes, actual_node, actual_server);
+
+    if(ev->type == job_arrival && actual_node == payment_control){
+      // the arrival that takes the last free server opens an excursion
+      if(nodes[payment_control].rejected_jobs == rejected && nodes[payment_control].node_jobs == c){
+        excursions++;
+        excursion_rejections = 0;
+        likelihood = 1;
+        tilted_arrivals = 0;
+        tilted_departures = 0;
+        tilted_time = 0;
+      }
+      else if(nodes[payment_control].rejected_jobs > rejected){
+        rejections++;
+        excursion_rejections++;
+        // at the first rejection of a tilted excursion the likelihood ratio of the Poisson arrivals and of the exponential
+        // services depends only on the arrivals, the completed services and the time since the start of the excursion
+        // (c busy servers at tilted_mu), then the rest of the excursion goes on with the original rates
+        if(tilting){
+          likelihood = exp(tilted_arrivals * log(result->rate / result->tilted_rate) + (result->tilted_rate - result->rate) * tilted_time
+                         + tilted_departures * log(result->mu / tilted_mu) - (result->mu - tilted_mu) * c * tilted_time);
+        }
+      }
+    }
+    // the departure that frees a server closes the excursion
+    else if(actual_node == payment_control && nodes[payment_control].node_jobs == c - 1 && tilted_cycle){
+      record_tilted_excursion(result, excursion_rejections, likelihood);
+    }
+
+    // the rates switch when an excursion starts or ends, or at its first rejection:
+    // services are memoryless, the ones in progress are drawn again with the new rate
+    if(actual_node == payment_control){
+      all_busy = tilted_cycle && excursion_rejections == 0 && nodes[payment_control].node_jobs >= c;
+      if(all_busy != tilting){
+        tilting = all_busy;
+        if(extra_pending && !tilting) free(RemoveEvent(list, job_arrival, payment_control, RARE_EVENT_SOURCE));
+        extra_pending = extra_pending && tilting;
+        resample_services(list, nodes, payment_control);
+      }
+    }
+
+    // while tilting, the extra arrivals raise the payment_control arrival rate to the service capacity
+    if(tilting && !extra_pending){
+      SelectStream(RARE_EVENT_STREAM);
+      next_time = current_time + idfExponential(1.0/(result->tilted_rate - result->rate), Random());
+      if(next_time < stop_time){
+        InsertEvent(list, GenerateEvent(job_arrival, payment_control, RARE_EVENT_SOURCE, next_time));
+        extra_pending = 1;
+      }
+    }
+    
+    free(ev);
+  }
+  tilting = 0;
+}
+
+void resample_services(event **list, node_stats *nodes, node_id node){
+  event *ev;
+  job *queued;
+  double residual;
+
+  // services are memoryless: residual services in progress and services of the queued jobs are drawn again
+  for(int s=0; s<nodes[node].total_servers; s++){
+    if(nodes[node].servers[s].status == busy){
+      ev = RemoveEvent(list, job_departure, node, s);
+      residual = GetService(node);
+      nodes[node].servers[s].serving_job->service += current_time + residual - ev->time;
+      ev->time = current_time + residual;
+      ev->next = NULL;
+      InsertEvent(list, ev);
+    }
+  }
+  for(queued = nodes[node].queue; queued != NULL; queued = queued->next) queued->service = GetService(node);
+}
+
+double check_precision(analysis **result, analysis **priority_result, long n, statistic_analysis *statistic_result, statistic_analysis *priority_statistic_result){
+  extract_statistic_analysis(result, statistic_result, n);
+  if(topology == improved){
+    extract_priority_statistic_analysis(result, priority_result, priority_statistic_result, n);
+    return precision_progress(statistic_result, priority_statistic_result, precision_metrics, precision);
+  }
+  return precision_progress(statistic_result, NULL, precision_metrics, precision);
+}
+
+void init_event_list(event **list){
+  event *new_arrival;
+  log_request *request;
+
+  // a replayed log has a single stream of requests for all the nodes, every replica starts it again
+  if(request_log.map != NULL){
+    rewind_arrival_log(&request_log, START);
+    request = current_request(&request_log);
+    new_arrival = GenerateEvent(job_arrival, request->entry, outside, START + request->time);
+    if(new_arrival->time < stop_time && external_arrivals < max_processable_jobs){
+      InsertEvent(list, new_arrival);
+      external_arrivals++;
+    }
+    return;
+  }
+  for(int node=0; node<nodes_num; node++){
+    if(time_varying && rates[node].points > 0) rewind_arrival_rates(&rates[node], START);
+    if(lambda[topology][node] != 0 || (time_varying && rates[node].points > 0)){
+      new_arrival = NextExternalArrival(node, START);
+      if(gradient && lambda[topology][node] > 0) external_derivative[node] = -(new_arrival->time - START) / lambda[topology][node];
+      if(new_arrival->time < stop_time && external_arrivals < max_processable_jobs){
+        InsertEvent(list, new_arrival);
+        external_arrivals++;
+      }
+    }
+  }
+}
+
+void init_servers(node_stats *nodes, int nodes_n){
+  server_stats *servers;
+  server_totals *totals;
+  double *derivatives = NULL;
+  int servers_n = 0;
+
+  // one block for the status of all the servers and one for their stats: the event loop only touches the first.
+  // The IPA derivatives of the servers and of the nodes are a cold block of their own, only with --gradient
+  for(int i=0; i<nodes_n; i++) servers_n += nodes[i].total_servers;
+  servers = calloc(servers_n, sizeof(server_stats));
+  totals = calloc(servers_n, sizeof(server_totals));
+  if(gradient) derivatives = calloc((servers_n + nodes_n) * IPA_PARAMETERS, sizeof(double));
+  if(servers == NULL || totals == NULL || (gradient && derivatives == NULL)){
+    printf("Error allocating memory for: server_stats\n");
+    exit(1);
+  }
+  for(int s=0; s<servers_n && gradient; s++) totals[s].departure_derivative = derivatives + s * IPA_PARAMETERS;
+  for(int i=0; i<nodes_n && gradient; i++) nodes[i].wait_derivative = derivatives + (servers_n + i) * IPA_PARAMETERS;
+  for(int i=0; i<nodes_n; i++){
+    nodes[i].servers = servers;
+    nodes[i].totals = totals;
+    servers += nodes[i].total_servers;
+    totals += nodes[i].total_servers;
+    init_idle_servers(&nodes[i]);
+  }
+}
+
+void init_nodes(node_stats **nodes){
+  *nodes = calloc(nodes_num, sizeof(node_stats));
+  if(*nodes == NULL){
+    printf("Error allocating memory for: nodes_stats\n");
+    exit(2);
+  }
+  for(int i=0; i<nodes_num; i++) (*nodes)[i].total_servers = servers_num[topology][i];
+  init_servers(*nodes, nodes_num);
+}
+
+void init_priority_nodes(node_stats **nodes, node_id node){
+  *nodes = calloc(classes_num, sizeof(node_stats));
+  if(*nodes == NULL){
+    printf("Error allocating memory for: nodes_stats\n");
+    exit(2);
   }
+  for(int i=0; i<classes_num; i++) (*nodes)[i].total_servers = servers_num[improved][node];
+  init_servers(*nodes, classes_num);
 }
 
 void init_areas(time_integrated **areas){
-  *areas = calloc(NODES, sizeof(time_integrated));
+  *areas = calloc(nodes_num, sizeof(time_integrated));
   if(*areas == NULL){
     printf("Error allocating memory for: time_integrated\n");
     exit(3);
@@ -592,26 +2610,26 @@ void init_areas(time_integrated **areas){
 }
 
 void init_priority_areas(time_integrated **areas){
-  *areas = calloc(PRIORITY_CLASSES, sizeof(time_integrated));
+  *areas = calloc(classes_num, sizeof(time_integrated));
   if(*areas == NULL){
     printf("Error allocating memory for: time_integrated\n");
     exit(3);
   }
 }
 
-void init_result(analysis ***result){
-  *result = calloc(iter_num, sizeof(analysis*));
+void init_result(analysis ***result, long n){
+  *result = calloc(n, sizeof(analysis*));
   if(*result == NULL){
     printf("Error allocating memory for: analysis\n");
     exit(4);
   }
-  for(int rep=0; rep<iter_num; rep++){
-    (*result)[rep] = calloc(NODES, sizeof(analysis));
+  for(int rep=0; rep<n; rep++){
+    (*result)[rep] = calloc(nodes_num, sizeof(analysis));
     if(*result == NULL){
       printf("Error allocating memory for: analysis\n");
       exit(4);
     }
-    for(int i=0; i<NODES; i++){
+    for(int i=0; i<nodes_num; i++){
       (*result)[rep][i].server_utilization = calloc(servers_num[topology][i], sizeof(double));
       (*result)[rep][i].server_service = calloc(servers_num[topology][i], sizeof(double));
       (*result)[rep][i].server_share = calloc(servers_num[topology][i], sizeof(double));
@@ -623,13 +2641,13 @@ void init_result(analysis ***result){
   }
 }
 
-void init_priority_result(analysis ***result){
-  *result = calloc(iter_num, sizeof(analysis*));
+void init_priority_result(analysis ***result, long n){
+  *result = calloc(n, sizeof(analysis*));
   if(*result == NULL){
     printf("Error allocating memory for: analysis\n");
     exit(4);
   }
-  for(int rep=0; rep<iter_num; rep++){
+  for(int rep=0; rep<n; rep++){
     (*result)[rep] = calloc(PRIORITY_CLASSES, sizeof(analysis));
     if(*result == NULL){
       printf("Error allocating memory for: analysis\n");